@@ -0,0 +1,364 @@
+#include "BatchSim.h"
+#include "FixedBoard.h"
+#include "Bitboard.h"
+
+using namespace std;
+
+typedef FixedBoard<10, 10, StandardFleet> StandardBoard;
+
+//*********************************************************************
+//  Cell masks of the 10x10 board, as two words
+//*********************************************************************
+
+//Masks of the cells in the first and last columns, of every
+//cell on the board, and of the cells whose row and column are
+//both even or both odd (the parity cells of GoodPlayer).
+
+struct BoardMasks
+{
+	uint64_t firstCol[2];
+	uint64_t lastCol[2];
+	uint64_t onBoard[2];
+	uint64_t parity[2];
+};
+
+static constexpr BoardMasks makeBoardMasks()
+{
+	BoardMasks m{};
+	for (int cell = 0; cell < StandardBoard::CELLS; cell++)
+	{
+		const uint64_t bit = uint64_t(1) << (cell & 63);
+		const int r = cell / StandardBoard::COLS;
+		const int c = cell % StandardBoard::COLS;
+		m.onBoard[cell >> 6] |= bit;
+		if (c == 0)
+			m.firstCol[cell >> 6] |= bit;
+		if (c == StandardBoard::COLS - 1)
+			m.lastCol[cell >> 6] |= bit;
+		if ((r + c) % 2 == 0)
+			m.parity[cell >> 6] |= bit;
+	}
+	return m;
+}
+
+static constexpr BoardMasks MASKS = makeBoardMasks();
+
+//The cells next to any cell of (lo, hi), in any of the four
+//directions. Shifting by one moves a cell along its row, and
+//shifting by a row's width moves it along its column.
+
+static inline void neighbours(uint64_t lo, uint64_t hi, uint64_t& nlo, uint64_t& nhi)
+{
+	const int W = StandardBoard::COLS;
+
+	const uint64_t eastLo = (lo << 1);
+	const uint64_t eastHi = (hi << 1) | (lo >> 63);
+	const uint64_t westLo = (lo >> 1) | (hi << 63);
+	const uint64_t westHi = (hi >> 1);
+	const uint64_t southLo = (lo << W);
+	const uint64_t southHi = (hi << W) | (lo >> (64 - W));
+	const uint64_t northLo = (lo >> W) | (hi << (64 - W));
+	const uint64_t northHi = (hi >> W);
+
+	nlo = ((eastLo & ~MASKS.firstCol[0]) | (westLo & ~MASKS.lastCol[0]) |
+		southLo | northLo) & MASKS.onBoard[0];
+	nhi = ((eastHi & ~MASKS.firstCol[1]) | (westHi & ~MASKS.lastCol[1]) |
+		southHi | northHi) & MASKS.onBoard[1];
+}
+
+//Pick one of the cells of (lo, hi) at random; it must not be
+//empty.
+
+static inline int pickCell(uint64_t lo, uint64_t hi, Rng& rng)
+{
+	const int nLo = popCount(lo);
+	int k = rng.randInt(nLo + popCount(hi));
+
+	uint64_t bits = lo;
+	int base = 0;
+	if (k >= nLo)
+	{
+		k -= nLo;
+		bits = hi;
+		base = 64;
+	}
+
+	for ( ; k > 0; k--)
+		bits &= bits - 1;
+
+	return base + lowestBit(bits);
+}
+
+//*********************************************************************
+//  BatchSim
+//*********************************************************************
+
+BatchSim::BatchSim(int nGames, uint64_t seed)
+ : m_n(nGames), m_rng(seed)
+{
+	for (int b = 0; b < 2; b++)
+	{
+		for (int w = 0; w < WORDS; w++)
+		{
+			m_occupied[b][w].assign(m_n, 0);
+			m_shots[b][w].assign(m_n, 0);
+			m_hits[b][w].assign(m_n, 0);
+			m_sunkCells[b][w].assign(m_n, 0);
+			for (int s = 0; s < NSHIPS; s++)
+				m_ship[b][s][w].assign(m_n, 0);
+		}
+		m_shotCount[b].assign(m_n, 0);
+	}
+
+	m_active.assign(m_n, 1);
+	m_winner.assign(m_n, -1);
+	m_target.assign(m_n, 0);
+}
+
+//Each ship goes at a random placement from the compile-time
+//table, drawn again until it overlaps no ship already placed.
+
+void BatchSim::placeFleets()
+{
+	const FixedPlacementTable<10, 10, StandardFleet>& table = StandardBoard::table;
+
+	for (int b = 0; b < 2; b++)
+	{
+		for (int n = 0; n < m_n; n++)
+		{
+			uint64_t used[WORDS] = { 0, 0 };
+
+			for (int s = 0; s < NSHIPS; s++)
+			{
+				const int first = table.offset[s];
+				const int count = table.offset[s + 1] - first;
+
+				while (true)
+				{
+					const FixedMask<10, 10>& mask = table.masks[first + m_rng.randInt(count)];
+					if ((mask.w[0] & used[0]) | (mask.w[1] & used[1]))
+						continue;
+					for (int w = 0; w < WORDS; w++)
+					{
+						m_ship[b][s][w][n] = mask.w[w];
+						used[w] |= mask.w[w];
+					}
+					break;
+				}
+			}
+
+			for (int w = 0; w < WORDS; w++)
+				m_occupied[b][w][n] = used[w];
+		}
+	}
+}
+
+//AwfulPlayer fires at the last cell first, then works back
+//one cell at a time, wrapping around.
+
+void BatchSim::chooseAwful(int side)
+{
+	const int cells = StandardBoard::CELLS;
+	const int16_t* count = m_shotCount[side].data();
+	int16_t* target = m_target.data();
+
+	for (int n = 0; n < m_n; n++)
+		target[n] = static_cast<int16_t>(cells - 1 - count[n] % cells);
+}
+
+//Fire next to a hit that is not part of a sunk ship if there
+//is one; otherwise fire at a parity cell, or failing that at
+//any cell not yet fired upon.
+
+void BatchSim::chooseHuntTarget(int side)
+{
+	const int b = 1 - side;
+
+	for (int n = 0; n < m_n; n++)
+	{
+		if (!m_active[n])
+			continue;
+
+		const uint64_t open[WORDS] = {
+			MASKS.onBoard[0] & ~m_shots[b][0][n],
+			MASKS.onBoard[1] & ~m_shots[b][1][n]
+		};
+
+		uint64_t nlo, nhi;
+		neighbours(m_hits[b][0][n] & ~m_sunkCells[b][0][n],
+			m_hits[b][1][n] & ~m_sunkCells[b][1][n], nlo, nhi);
+		nlo &= open[0];
+		nhi &= open[1];
+
+		if ((nlo | nhi) == 0)
+		{
+			nlo = open[0] & MASKS.parity[0];
+			nhi = open[1] & MASKS.parity[1];
+			if ((nlo | nhi) == 0)
+			{
+				nlo = open[0];
+				nhi = open[1];
+			}
+		}
+
+		m_target[n] = static_cast<int16_t>(pickCell(nlo, nhi, m_rng));
+	}
+}
+
+//Fire every live game's chosen shot at once. The shot's bit is
+//worked out for both words without branching, and finished
+//games get an empty bit.
+
+void BatchSim::attack(int side)
+{
+	const int b = 1 - side;
+	const int16_t* target = m_target.data();
+	const uint8_t* active = m_active.data();
+	uint64_t* shots0 = m_shots[b][0].data();
+	uint64_t* shots1 = m_shots[b][1].data();
+	uint64_t* hits0 = m_hits[b][0].data();
+	uint64_t* hits1 = m_hits[b][1].data();
+	const uint64_t* occ0 = m_occupied[b][0].data();
+	const uint64_t* occ1 = m_occupied[b][1].data();
+	int16_t* count = m_shotCount[side].data();
+
+	for (int n = 0; n < m_n; n++)
+	{
+		const uint64_t live = 0 - static_cast<uint64_t>(active[n]);
+		const int cell = target[n];
+		const uint64_t inHi = 0 - static_cast<uint64_t>(cell >> 6);
+		const uint64_t bit = (uint64_t(1) << (cell & 63)) & live;
+		const uint64_t bit0 = bit & ~inHi;
+		const uint64_t bit1 = bit & inHi;
+
+		shots0[n] |= bit0;
+		shots1[n] |= bit1;
+		hits0[n] |= bit0 & occ0[n];
+		hits1[n] |= bit1 & occ1[n];
+		count[n] += active[n];
+	}
+}
+
+//A ship is sunk once none of its cells is left unhit; its
+//cells are then known to the side that sank it.
+
+void BatchSim::resolveSinks(int board)
+{
+	uint64_t* sunk0 = m_sunkCells[board][0].data();
+	uint64_t* sunk1 = m_sunkCells[board][1].data();
+	const uint64_t* hits0 = m_hits[board][0].data();
+	const uint64_t* hits1 = m_hits[board][1].data();
+
+	for (int s = 0; s < NSHIPS; s++)
+	{
+		const uint64_t* ship0 = m_ship[board][s][0].data();
+		const uint64_t* ship1 = m_ship[board][s][1].data();
+
+		for (int n = 0; n < m_n; n++)
+		{
+			const uint64_t afloat = (ship0[n] & ~hits0[n]) | (ship1[n] & ~hits1[n]);
+			const uint64_t sunk = 0 - static_cast<uint64_t>(afloat == 0);
+			sunk0[n] |= ship0[n] & sunk;
+			sunk1[n] |= ship1[n] & sunk;
+		}
+	}
+}
+
+//Finish every live game in which side has now hit every
+//occupied cell. Returns the number of games still going.
+
+int BatchSim::gameOver(int side)
+{
+	const int b = 1 - side;
+	const uint64_t* hits0 = m_hits[b][0].data();
+	const uint64_t* hits1 = m_hits[b][1].data();
+	const uint64_t* occ0 = m_occupied[b][0].data();
+	const uint64_t* occ1 = m_occupied[b][1].data();
+	uint8_t* active = m_active.data();
+	int8_t* winner = m_winner.data();
+	int live = 0;
+
+	for (int n = 0; n < m_n; n++)
+	{
+		const uint8_t won = active[n] &
+			static_cast<uint8_t>(((occ0[n] & ~hits0[n]) | (occ1[n] & ~hits1[n])) == 0);
+		winner[n] = won ? static_cast<int8_t>(side) : winner[n];
+		active[n] &= static_cast<uint8_t>(!won);
+		live += active[n];
+	}
+
+	return live;
+}
+
+void BatchSim::run(BatchStrategy first, BatchStrategy second)
+{
+	const BatchStrategy strategy[2] = { first, second };
+
+	placeFleets();
+
+	int live = m_n;
+	while (live > 0)
+	{
+		for (int side = 0; side < 2 && live > 0; side++)
+		{
+			if (strategy[side] == BATCH_AWFUL)
+				chooseAwful(side);
+			else
+				chooseHuntTarget(side);
+
+			attack(side);
+			if (strategy[side] == BATCH_HUNT_TARGET)
+				resolveSinks(1 - side);
+			live = gameOver(side);
+		}
+	}
+}
+
+//*********************************************************************
+//  runBatchMatch
+//*********************************************************************
+
+MatchResult runBatchMatch(BatchStrategy s0, BatchStrategy s1, long long nGames,
+	uint64_t seed, int batchSize)
+{
+	MatchResult result;
+	result.seed = (seed != 0 ? seed : Rng::randomSeed());
+
+	const BatchStrategy strategy[2] = { s0, s1 };
+	long long batchNumber = 0;
+	GameSummary summary;
+
+	//Strategy 0 moves first in the odd-numbered games and
+	//strategy 1 in the even-numbered ones, as in runMatch
+
+	for (int firstMover = 0; firstMover < 2; firstMover++)
+	{
+		long long left = (firstMover == 0 ? (nGames + 1) / 2 : nGames / 2);
+
+		while (left > 0)
+		{
+			const int n = static_cast<int>(left < batchSize ? left : batchSize);
+
+			BatchSim sim(n, gameSeed(result.seed, ++batchNumber));
+			sim.run(strategy[firstMover], strategy[1 - firstMover]);
+
+			for (int k = 0; k < n; k++)
+			{
+				const int w = sim.winner(k);
+				const int winner = (w == 0 ? firstMover : 1 - firstMover);
+				result.shots[firstMover] += sim.shots(0, k);
+				result.shots[1 - firstMover] += sim.shots(1, k);
+
+				summary.firstMover = firstMover;
+				summary.winner = winner;
+				summary.shots[firstMover] = sim.shots(0, k);
+				summary.shots[1 - firstMover] = sim.shots(1, k);
+				result.stats.record(summary);
+			}
+
+			left -= n;
+		}
+	}
+
+	return result;
+}
@@ -0,0 +1,76 @@
+
+#ifndef BATCHSIM_INCLUDED
+#define BATCHSIM_INCLUDED
+
+#include "Match.h"
+#include "globals.h"
+#include <vector>
+#include <cstdint>
+
+// A BatchSim plays many standard games (10x10, StandardFleet) at once, with
+// one of a few built-in strategies on each side.  Instead of a Board and a
+// pair of Players per game, it holds every game's boards as rows of
+// struct-of-arrays buffers, one entry per game, and advances all the games
+// that are still going by one half-turn at a time.  Each step is a loop
+// over the games with no calls and few branches, which the compiler can
+// turn into SIMD code.
+//
+// The fleets are placed at random.  A strategy sees only its own shots,
+// which of them hit, and the cells of each ship it has sunk.
+
+enum BatchStrategy
+{
+    BATCH_AWFUL,        // sweeps the board from the last cell back, as AwfulPlayer
+    BATCH_HUNT_TARGET   // parity hunt, then the cells next to unresolved hits
+};
+
+class BatchSim
+{
+public:
+    BatchSim(int nGames, std::uint64_t seed);
+
+      // Play every game to its end, with first moving first in all of them
+    void run(BatchStrategy first, BatchStrategy second);
+
+      // 0 if the first mover won game n, 1 if the second did
+    int winner(int n) const { return m_winner[n]; }
+    int shots(int side, int n) const { return m_shotCount[side][n]; }
+    int nGames() const { return m_n; }
+
+private:
+    static const int WORDS = 2;     // 100 cells
+    static const int NSHIPS = 5;
+
+    void placeFleets();
+    void chooseAwful(int side);
+    void chooseHuntTarget(int side);
+    void attack(int side);
+    void resolveSinks(int board);
+    int gameOver(int side);
+
+    int m_n;
+    Rng m_rng;
+
+      // Board b belongs to side b and is fired upon by side 1-b.  Each
+      // vector holds one word of a cell mask for every game.
+    std::vector<std::uint64_t> m_occupied[2][WORDS];
+    std::vector<std::uint64_t> m_ship[2][NSHIPS][WORDS];
+    std::vector<std::uint64_t> m_shots[2][WORDS];
+    std::vector<std::uint64_t> m_hits[2][WORDS];
+    std::vector<std::uint64_t> m_sunkCells[2][WORDS];
+
+    std::vector<std::uint8_t> m_active;
+    std::vector<std::int8_t> m_winner;
+    std::vector<std::int16_t> m_shotCount[2];
+    std::vector<std::int16_t> m_target;
+};
+
+  // Play nGames standard games between two batch strategies in batches of
+  // batchSize.  As with runMatch, strategy 0 moves first in the
+  // odd-numbered games, and the result has the same form, except that
+  // stats.timeToSink is left empty, since a batch does not track which
+  // shot sank each ship.
+MatchResult runBatchMatch(BatchStrategy s0, BatchStrategy s1, long long nGames,
+                          std::uint64_t seed = 0, int batchSize = 4096);
+
+#endif // BATCHSIM_INCLUDED
@@ -0,0 +1,157 @@
+
+#ifndef BITBOARD_INCLUDED
+#define BITBOARD_INCLUDED
+
+#include "globals.h"
+#include <cstdint>
+
+// A Bitboard holds one bit per cell of a board, with cell (r, c) stored at
+// bit r * cols + c.  It has room for boards of up to 256 cells, which takes
+// in the standard 10x10 board, so set operations on whole boards are a
+// handful of word ops.  Larger boards are not kept as Bitboards.
+
+const int BITBOARD_WORDS = 4;
+
+constexpr int popCount(std::uint64_t x)
+{
+#if defined(__GNUC__) || defined(__clang__)
+    return __builtin_popcountll(x);
+#else
+    int n = 0;
+    for ( ; x != 0; x &= x - 1)
+        n++;
+    return n;
+#endif
+}
+
+  // The index of the lowest set bit of x, which must not be 0
+constexpr int lowestBit(std::uint64_t x)
+{
+#if defined(__GNUC__) || defined(__clang__)
+    return __builtin_ctzll(x);
+#else
+    return popCount((x & (0 - x)) - 1);
+#endif
+}
+
+class Bitboard
+{
+public:
+    Bitboard()
+    {
+        for (int w = 0; w < BITBOARD_WORDS; w++)
+            m_words[w] = 0;
+    }
+
+    bool test(int bit) const
+    {
+        return (m_words[bit >> 6] >> (bit & 63)) & 1;
+    }
+    void set(int bit)   { m_words[bit >> 6] |= std::uint64_t(1) << (bit & 63); }
+    void reset(int bit) { m_words[bit >> 6] &= ~(std::uint64_t(1) << (bit & 63)); }
+
+    void clear()
+    {
+        for (int w = 0; w < BITBOARD_WORDS; w++)
+            m_words[w] = 0;
+    }
+
+    bool any() const
+    {
+        std::uint64_t acc = 0;
+        for (int w = 0; w < BITBOARD_WORDS; w++)
+            acc |= m_words[w];
+        return acc != 0;
+    }
+    bool none() const { return !any(); }
+
+    int count() const
+    {
+        int n = 0;
+        for (int w = 0; w < BITBOARD_WORDS; w++)
+            n += popCount(m_words[w]);
+        return n;
+    }
+
+      // True if the two boards share at least one cell
+    bool intersects(const Bitboard& other) const
+    {
+        std::uint64_t acc = 0;
+        for (int w = 0; w < BITBOARD_WORDS; w++)
+            acc |= m_words[w] & other.m_words[w];
+        return acc != 0;
+    }
+
+      // True if every cell of this board is also in other
+    bool isSubsetOf(const Bitboard& other) const
+    {
+        std::uint64_t acc = 0;
+        for (int w = 0; w < BITBOARD_WORDS; w++)
+            acc |= m_words[w] & ~other.m_words[w];
+        return acc == 0;
+    }
+
+    Bitboard& operator|=(const Bitboard& other)
+    {
+        for (int w = 0; w < BITBOARD_WORDS; w++)
+            m_words[w] |= other.m_words[w];
+        return *this;
+    }
+    Bitboard& operator&=(const Bitboard& other)
+    {
+        for (int w = 0; w < BITBOARD_WORDS; w++)
+            m_words[w] &= other.m_words[w];
+        return *this;
+    }
+      // Remove every cell of other from this board
+    Bitboard& andNot(const Bitboard& other)
+    {
+        for (int w = 0; w < BITBOARD_WORDS; w++)
+            m_words[w] &= ~other.m_words[w];
+        return *this;
+    }
+
+    bool operator==(const Bitboard& other) const
+    {
+        for (int w = 0; w < BITBOARD_WORDS; w++)
+            if (m_words[w] != other.m_words[w])
+                return false;
+        return true;
+    }
+    bool operator!=(const Bitboard& other) const { return !(*this == other); }
+
+    std::uint64_t word(int w) const { return m_words[w]; }
+    const std::uint64_t* words() const { return m_words; }
+    void setWord(int w, std::uint64_t bits) { m_words[w] = bits; }
+
+      // Each of the first nCells cells is in the result with probability 1/2
+    static Bitboard random(int nCells, Rng& rng)
+    {
+        Bitboard b;
+        for (int w = 0; w * 64 < nCells; w++)
+        {
+            std::uint64_t bits = rng.next();
+            if (nCells - w * 64 < 64)
+                bits &= (std::uint64_t(1) << (nCells - w * 64)) - 1;
+            b.m_words[w] = bits;
+        }
+        return b;
+    }
+
+private:
+    std::uint64_t m_words[BITBOARD_WORDS];
+};
+
+inline Bitboard operator|(Bitboard a, const Bitboard& b) { return a |= b; }
+inline Bitboard operator&(Bitboard a, const Bitboard& b) { return a &= b; }
+
+  // Call f(cell) for every cell of the board, in increasing order
+template <class F>
+inline void forEachCell(const Bitboard& b, F f)
+{
+    for (int w = 0; w < BITBOARD_WORDS; w++)
+        for (std::uint64_t bits = b.word(w); bits != 0; bits &= bits - 1)
+            f(w * 64 + lowestBit(bits));
+}
+
+#endif // BITBOARD_INCLUDED
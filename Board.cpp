@@ -1,403 +1,710 @@
-#include "Board.h"
-#include "Game.h"
-#include "globals.h"
-#include <iostream>
-
-using namespace std;
-
-class BoardImpl
-{
-  public:
-    BoardImpl(const Game& g);
-    void clear();
-    void block();
-    void unblock();
-    bool placeShip(Point topOrLeft, int shipId, Direction dir);
-    bool unplaceShip(Point topOrLeft, int shipId, Direction dir);
-    void display(bool shotsOnly) const;
-    bool attack(Point p, bool& shotHit, bool& shipDestroyed, int& shipId);
-    bool allShipsDestroyed() const;
-
-  private:
-	char gameBoard[MAXROWS][MAXCOLS];
-	char shipSym[100];
-
-	bool find(char value);
-
-    const Game& m_game;
-};
-
-BoardImpl::BoardImpl(const Game& g)
- : m_game(g)
-{
-	for (int k = 0; k < MAXROWS; k++)
-		for (int j = 0; j < MAXCOLS; j++)
-			gameBoard[k][j] = '.';
-	for (int k = 0; k < 100; k++)
-		shipSym[k] = 'X';
-}
-
-bool BoardImpl::find(char value)
-{
-	const int row = m_game.rows();
-	const int col = m_game.cols();
-
-	for (int k = 0; k < row; k++)
-	{
-		for (int j = 0; j < col; j++)
-		{
-			if (gameBoard[k][j] == value)
-				return true;
-		}
-	}
-
-	return false;
-}
-
-void BoardImpl::clear()
-{
-	for (int k = 0; k < MAXROWS; k++)
-		for (int j = 0; j < MAXCOLS; j++)
-			gameBoard[k][j] = '.';
-}
-
-void BoardImpl::block()
-{
-      // Block cells with 50% probability
-    for (int r = 0; r < m_game.rows(); r++)
-        for (int c = 0; c < m_game.cols(); c++)
-            if (randInt(2) == 0)
-            {
-                gameBoard[r][c] = 'o'; // no ship can used o as its symbol
-            }
-}
-
-void BoardImpl::unblock()
-{
-    for (int r = 0; r < m_game.rows(); r++)
-        for (int c = 0; c < m_game.cols(); c++)
-        {
-			if (gameBoard[r][c] == 'o')
-				gameBoard[r][c] = '.';
-        }
-}
-
-//Place the ship if the ship can be placed at
-//the indicated location.
-
-bool BoardImpl::placeShip(Point topOrLeft, int shipId, Direction dir)
-{
-	const int row = topOrLeft.r;
-	const int col = topOrLeft.c;
-
-	if (!m_game.isValid(topOrLeft))
-		return false;
-
-	if (shipId < 0 || shipId >= m_game.nShips())
-		return false;
-
-	char symbol = m_game.shipSymbol(shipId);
-	int length = m_game.shipLength(shipId);
-
-	if (find(symbol))
-		return false;
-	
-	if (dir == HORIZONTAL)
-	{
-		int limit = col + length - 1;
-		if (limit >= m_game.cols())
-			return false;
-
-		for (int k = col; k <= limit; k++)
-		{
-			if (gameBoard[row][k] != '.')
-				return false;
-		}
-
-		for (int k = col; k <= limit; k++)
-			gameBoard[row][k] = symbol;
-
-		shipSym[shipId] = symbol;
-
-		return true;
-	}
-
-	else if (dir == VERTICAL)
-	{
-		int limit = row + length - 1;
-		if (limit >= m_game.rows())
-			return false;
-
-		for (int k = row; k <= limit; k++)
-		{
-			if (gameBoard[k][col] != '.')
-				return false;
-		}
-
-		for (int k = row; k <= limit; k++)
-			gameBoard[k][col] = symbol;
-
-		shipSym[shipId] = symbol;
-
-		return true;
-	}
-
-    return false;
-}
-
-//Remove all ship symbols from the board if there
-//does exist a corresponding ship at the indicated
-//location.
-
-bool BoardImpl::unplaceShip(Point topOrLeft, int shipId, Direction dir)
-{
-	if (shipId < 0 || shipId >= m_game.nShips())
-		return false;
-
-	const char symbol = m_game.shipSymbol(shipId);
-	const int length = m_game.shipLength(shipId);
-	const int row = topOrLeft.r;
-	const int col = topOrLeft.c;
-
-	if (gameBoard[row][col] != symbol)
-		return false;
-
-	if (!find(symbol))
-		return false;
-
-	if (dir == HORIZONTAL)
-	{
-		int limit = col + length - 1;
-		if (limit >= m_game.cols())
-			return false;
-
-		for (int k = col; k <= limit; k++)
-		{
-			if (gameBoard[row][k] != symbol)
-				return false;
-		}
-
-		for (int k = 0; k < 10; k++)
-		{
-			for (int j = 0; j < 10; j++)
-			{
-				if (gameBoard[k][j] == symbol)
-					gameBoard[k][j] = '.';
-			}
-		}
-
-		shipSym[shipId] = 'X';
-
-		return true;
-	}
-
-	else if (dir == VERTICAL)
-	{
-		int limit = row + length - 1;
-		if (limit >= m_game.rows())
-			return false;
-
-		for (int k = row; k <= limit; k++)
-		{
-			if (gameBoard[k][col] != symbol)
-				return false;
-		}
-
-		for (int k = 0; k < 10; k++)
-		{
-			for (int j = 0; j < 10; j++)
-			{
-				if (gameBoard[k][j] == symbol)
-					gameBoard[k][j] = '.';
-			}
-		}
-
-		shipSym[shipId] = 'X';
-
-		return true;
-	}
-
-    return false;
-}
-
-//cout all elements in the two-dimensional array that
-//represents the board. Depending on shotsOnly, block
-//out the ship placements.
-
-void BoardImpl::display(bool shotsOnly) const
-{
-	if (shotsOnly)
-	{
-		cout << "  ";
-		for (int k = 0; k < m_game.rows(); k++)
-			cout << k;
-		cout << endl;
-		for (int k = 0; k < m_game.rows(); k++)
-		{
-			cout << k << " ";
-
-			for (int j = 0; j < m_game.cols(); j++)
-			{
-				switch (gameBoard[k][j])
-				{
-				case 'o':
-				case 'X':
-					cout << gameBoard[k][j];
-					break;
-				default:
-					cout << '.';
-					break;
-				}
-			}
-
-			cout << endl;
-		}
-	}
-
-	else
-	{
-		cout << "  ";
-		for (int k = 0; k < m_game.rows(); k++)
-			cout << k;
-		cout << endl;
-
-		for (int k = 0; k < m_game.rows(); k++)
-		{
-			cout << k << " ";
-			for (int j = 0; j < m_game.cols(); j++)
-				cout << gameBoard[k][j];
-			cout << endl;
-		}
-	}
-}
-
-//The attacks are represented by different symbols,
-//either o or X, depending on the result. If the ship
-//hit does not have any more symbols on the board, it
-//must have been destroyed.
-
-bool BoardImpl::attack(Point p, bool& shotHit, bool& shipDestroyed, int& shipId)
-{
-	shotHit = false;
-	const int row = p.r;
-	const int col = p.c;
-
-	if (!m_game.isValid(p))
-		return false;
-
-	if (gameBoard[row][col] == 'X' || gameBoard[row][col] == 'o')
-		return false;
-
-	else if (gameBoard[row][col] == '.')
-	{
-		gameBoard[row][col] = 'o';
-		return true;		
-	}
-
-	else
-	{
-		shotHit = true;
-		char sym = gameBoard[row][col];
-		gameBoard[row][col] = 'X';
-
-		if (find(sym))
-			shipDestroyed = false;
-		else
-		{
-			shipDestroyed = true;
-			int k = 0;
-
-			for (; k < m_game.nShips(); k++)
-			{
-				if (shipSym[k] == sym)
-					break;
-			}
-
-			shipId = k;
-		}
-		return true;
-	}
-
-    return false;
-}
-
-//If there exists no ship symbols on the board
-//then all ships must have been destroyed.
-
-bool BoardImpl::allShipsDestroyed() const
-{
-	for (int k = 0; k < m_game.rows(); k++)
-	{
-		for (int j = 0; j < m_game.cols(); j++)
-		{
-			switch (gameBoard[k][j])
-			{
-			case 'X':
-			case '.':
-			case 'o':
-				break;
-			default:
-				return false;
-			}
-		}
-	}
-
-    return true; 
-}
-
-
-
-//******************** Board functions ********************************
-
-// These functions simply delegate to BoardImpl's functions.
-// You probably don't want to change any of this code.
-
-Board::Board(const Game& g)
-{
-    m_impl = new BoardImpl(g);
-}
-
-Board::~Board()
-{
-    delete m_impl;
-}
-
-void Board::clear()
-{
-    m_impl->clear();
-}
-
-void Board::block()
-{
-    return m_impl->block();
-}
-
-void Board::unblock()
-{
-    return m_impl->unblock();
-}
-
-bool Board::placeShip(Point topOrLeft, int shipId, Direction dir)
-{
-    return m_impl->placeShip(topOrLeft, shipId, dir);
-}
-
-bool Board::unplaceShip(Point topOrLeft, int shipId, Direction dir)
-{
-    return m_impl->unplaceShip(topOrLeft, shipId, dir);
-}
-
-void Board::display(bool shotsOnly) const
-{
-    m_impl->display(shotsOnly);
-}
-
-bool Board::attack(Point p, bool& shotHit, bool& shipDestroyed, int& shipId)
-{
-    return m_impl->attack(p, shotHit, shipDestroyed, shipId);
-}
-
-bool Board::allShipsDestroyed() const
-{
-    return m_impl->allShipsDestroyed();
+#include "Board.h"
+#include "Game.h"
+#include "globals.h"
+#include "Bitboard.h"
+#include "PlacementTable.h"
+#include "FixedBoard.h"
+#include "BoardRenderer.h"
+#include <vector>
+#include <memory>
+#include <unordered_map>
+#include <cstdint>
+#include <algorithm>
+
+using namespace std;
+
+//A board is kept in one of three ways. The standard game is
+//played on a FixedBoardImpl, whose size and fleet are fixed
+//at compile time. Other boards small enough for a Bitboard use
+//BitboardImpl; anything larger uses SparseBoardImpl, whose
+//size depends only on the ships and shots actually on it.
+
+class BoardImpl
+{
+  public:
+    virtual ~BoardImpl() {}
+    virtual void clear() = 0;
+    virtual void block() = 0;
+    virtual void unblock() = 0;
+    virtual bool placeShip(Point topOrLeft, int shipId, Direction dir) = 0;
+    virtual bool unplaceShip(Point topOrLeft, int shipId, Direction dir) = 0;
+    virtual const Game& game() const = 0;
+    virtual void cellSymbols(char* cells, bool shotsOnly) const = 0;
+    virtual bool attack(Point p, bool& shotHit, bool& shipDestroyed, int& shipId) = 0;
+    virtual bool allShipsDestroyed() const = 0;
+    virtual bool shipPlacement(int shipId, Point& topOrLeft, Direction& dir) const = 0;
+};
+
+//*********************************************************************
+//  FixedBoardImpl
+//*********************************************************************
+
+template <int R, int C, class F>
+class FixedBoardImpl : public BoardImpl
+{
+  public:
+    FixedBoardImpl(const Game& g) : m_game(g) {}
+    static bool matches(const Game& g);
+    virtual void clear() { m_board.clear(); }
+    virtual void block();
+    virtual void unblock() { m_board.unblock(); }
+    virtual bool placeShip(Point topOrLeft, int shipId, Direction dir)
+    {
+        return m_board.placeShip(topOrLeft.r, topOrLeft.c, shipId, dir);
+    }
+    virtual bool unplaceShip(Point topOrLeft, int shipId, Direction dir)
+    {
+        return m_board.unplaceShip(topOrLeft.r, topOrLeft.c, shipId, dir);
+    }
+    virtual const Game& game() const { return m_game; }
+    virtual void cellSymbols(char* cells, bool shotsOnly) const;
+    virtual bool attack(Point p, bool& shotHit, bool& shipDestroyed, int& shipId)
+    {
+        return m_board.attack(p.r, p.c, shotHit, shipDestroyed, shipId);
+    }
+    virtual bool allShipsDestroyed() const { return m_board.allShipsDestroyed(); }
+    virtual bool shipPlacement(int shipId, Point& topOrLeft, Direction& dir) const
+    {
+        return m_board.placement(shipId, topOrLeft.r, topOrLeft.c, dir);
+    }
+
+  private:
+	FixedBoard<R, C, F> m_board;
+    const Game& m_game;
+};
+
+//Only a game with exactly this board size and fleet can be
+//played on this kind of board.
+
+template <int R, int C, class F>
+bool FixedBoardImpl<R, C, F>::matches(const Game& g)
+{
+	if (g.rows() != R || g.cols() != C || g.nShips() != F::nShips)
+		return false;
+
+	for (int s = 0; s < F::nShips; s++)
+		if (g.shipLength(s) != F::lengths[s])
+			return false;
+
+	return true;
+}
+
+template <int R, int C, class F>
+void FixedBoardImpl<R, C, F>::block()
+{
+	typename FixedBoard<R, C, F>::Mask cells;
+	Bitboard random = Bitboard::random(R * C, m_game.rng());
+
+	for (int w = 0; w < FixedMask<R, C>::WORDS; w++)
+		cells.w[w] = random.word(w);
+
+	m_board.block(cells);
+}
+
+template <int R, int C, class F>
+void FixedBoardImpl<R, C, F>::cellSymbols(char* cells, bool shotsOnly) const
+{
+	for (int cell = 0; cell < R * C; cell++)
+	{
+		if (m_board.isHit(cell))
+			cells[cell] = 'X';
+		else if (m_board.isShot(cell) || m_board.isBlocked(cell))
+			cells[cell] = 'o';
+		else if (shotsOnly || m_board.owner(cell) < 0)
+			cells[cell] = '.';
+		else
+			cells[cell] = m_game.shipSymbol(m_board.owner(cell));
+	}
+}
+
+//*********************************************************************
+//  BitboardImpl
+//*********************************************************************
+
+class BitboardImpl : public BoardImpl
+{
+  public:
+    BitboardImpl(const Game& g);
+    virtual void clear();
+    virtual void block();
+    virtual void unblock();
+    virtual bool placeShip(Point topOrLeft, int shipId, Direction dir);
+    virtual bool unplaceShip(Point topOrLeft, int shipId, Direction dir);
+    virtual const Game& game() const { return m_game; }
+    virtual void cellSymbols(char* cells, bool shotsOnly) const;
+    virtual bool attack(Point p, bool& shotHit, bool& shipDestroyed, int& shipId);
+    virtual bool allShipsDestroyed() const;
+    virtual bool shipPlacement(int shipId, Point& topOrLeft, Direction& dir) const;
+
+  private:
+	//The board is kept as a set of bitboards: one occupancy
+	//mask per ship, their union, and the cells that have been
+	//blocked, shot at, and hit. Each cell also records the id
+	//of the ship on it, and each ship counts its cells that
+	//have not been hit yet.
+
+	vector<Bitboard> m_shipMask;
+	Bitboard m_occupied;
+	Bitboard m_blocked;
+	Bitboard m_shots;
+	Bitboard m_hits;
+
+	int16_t m_owner[BITBOARD_WORDS * 64];
+	vector<int> m_shipAfloat;
+	int m_cellsAfloat;
+
+	int m_rows;
+	int m_cols;
+
+	//Ship masks come from the placement table shared by every
+	//board of the same geometry
+
+	shared_ptr<const PlacementTable> m_table;
+
+	int cellIndex(int r, int c) const { return r * m_cols + c; }
+	const Bitboard* shipMask(Point topOrLeft, int shipId, Direction dir);
+	char cellSymbol(int r, int c, bool shotsOnly) const;
+
+    const Game& m_game;
+};
+
+BitboardImpl::BitboardImpl(const Game& g)
+ : m_shipMask(g.nShips()), m_shipAfloat(g.nShips(), 0), m_cellsAfloat(0),
+	m_rows(g.rows()), m_cols(g.cols()), m_table(PlacementTable::forGame(g)),
+	m_game(g)
+{}
+
+//Look up the cells a ship would cover. Returns nullptr if
+//it would leave the board.
+
+const Bitboard* BitboardImpl::shipMask(Point topOrLeft, int shipId, Direction dir)
+{
+	//Ships may have been added to the game since the
+	//board was made
+
+	if (shipId >= m_table->nShips())
+		m_table = PlacementTable::forGame(m_game);
+
+	const int k = m_table->indexOf(shipId, topOrLeft, dir);
+	if (k < 0)
+		return nullptr;
+
+	return &m_table->mask(shipId, k);
+}
+
+void BitboardImpl::clear()
+{
+	for (size_t k = 0; k < m_shipMask.size(); k++)
+		m_shipMask[k].clear();
+	m_occupied.clear();
+	m_blocked.clear();
+	m_shots.clear();
+	m_hits.clear();
+	m_shipAfloat.assign(m_shipAfloat.size(), 0);
+	m_cellsAfloat = 0;
+}
+
+void BitboardImpl::block()
+{
+      // Block cells with 50% probability
+    m_blocked |= Bitboard::random(m_rows * m_cols, m_game.rng());
+}
+
+void BitboardImpl::unblock()
+{
+	m_blocked.clear();
+}
+
+//Place the ship if the ship can be placed at
+//the indicated location.
+
+bool BitboardImpl::placeShip(Point topOrLeft, int shipId, Direction dir)
+{
+	if (shipId < 0 || shipId >= m_game.nShips())
+		return false;
+
+	if (shipId >= static_cast<int>(m_shipMask.size()))
+	{
+		m_shipMask.resize(m_game.nShips());
+		m_shipAfloat.resize(m_game.nShips(), 0);
+	}
+
+	if (m_shipMask[shipId].any())
+		return false;
+
+	const Bitboard* mask = shipMask(topOrLeft, shipId, dir);
+	if (mask == nullptr)
+		return false;
+
+	if (mask->intersects(m_occupied | m_blocked | m_shots))
+		return false;
+
+	m_shipMask[shipId] = *mask;
+	m_occupied |= *mask;
+
+	const int length = m_game.shipLength(shipId);
+	for (int k = 0; k < length; k++)
+	{
+		const int idx = (dir == HORIZONTAL ? cellIndex(topOrLeft.r, topOrLeft.c + k)
+			: cellIndex(topOrLeft.r + k, topOrLeft.c));
+		m_owner[idx] = static_cast<int16_t>(shipId);
+	}
+	m_shipAfloat[shipId] = length;
+	m_cellsAfloat += length;
+
+	return true;
+}
+
+//Remove the ship from the board if it does occupy
+//exactly the indicated location.
+
+bool BitboardImpl::unplaceShip(Point topOrLeft, int shipId, Direction dir)
+{
+	if (shipId < 0 || shipId >= static_cast<int>(m_shipMask.size()))
+		return false;
+
+	const Bitboard* mask = shipMask(topOrLeft, shipId, dir);
+	if (mask == nullptr || *mask != m_shipMask[shipId])
+		return false;
+
+	m_occupied.andNot(*mask);
+	m_hits.andNot(*mask);
+	m_shipMask[shipId].clear();
+	m_cellsAfloat -= m_shipAfloat[shipId];
+	m_shipAfloat[shipId] = 0;
+
+	return true;
+}
+
+//Work out what a cell looks like. Shots are drawn as
+//o or X depending on the result; ships are only shown
+//when shotsOnly is false.
+
+char BitboardImpl::cellSymbol(int r, int c, bool shotsOnly) const
+{
+	const int idx = cellIndex(r, c);
+
+	if (m_hits.test(idx))
+		return 'X';
+	if (m_shots.test(idx) || m_blocked.test(idx))
+		return 'o';
+	if (shotsOnly || !m_occupied.test(idx))
+		return '.';
+
+	return m_game.shipSymbol(m_owner[idx]);
+}
+
+//The symbols of all cells of the board. Depending on
+//shotsOnly, block out the ship placements.
+
+void BitboardImpl::cellSymbols(char* cells, bool shotsOnly) const
+{
+	for (int k = 0; k < m_rows; k++)
+		for (int j = 0; j < m_cols; j++)
+			cells[k * m_cols + j] = cellSymbol(k, j, shotsOnly);
+}
+
+//The cell's owner and its counter of unhit cells tell at
+//once whether a hit destroyed a ship.
+
+bool BitboardImpl::attack(Point p, bool& shotHit, bool& shipDestroyed, int& shipId)
+{
+	shotHit = false;
+	shipDestroyed = false;
+
+	if (!m_game.isValid(p))
+		return false;
+
+	const int idx = cellIndex(p.r, p.c);
+
+	if (m_shots.test(idx) || m_blocked.test(idx))
+		return false;
+
+	m_shots.set(idx);
+
+	if (!m_occupied.test(idx))
+		return true;
+
+	shotHit = true;
+	m_hits.set(idx);
+	m_cellsAfloat--;
+
+	const int owner = m_owner[idx];
+	if (--m_shipAfloat[owner] == 0)
+	{
+		shipDestroyed = true;
+		shipId = owner;
+	}
+
+	return true;
+}
+
+//All ships are destroyed once every occupied cell
+//has been hit.
+
+bool BitboardImpl::allShipsDestroyed() const
+{
+	return m_cellsAfloat == 0;
+}
+
+//The ship starts at the lowest cell of its mask, and lies
+//across the board if the next cell is also part of it
+
+bool BitboardImpl::shipPlacement(int shipId, Point& topOrLeft, Direction& dir) const
+{
+	if (shipId < 0 || shipId >= static_cast<int>(m_shipMask.size()) ||
+		m_shipMask[shipId].none())
+		return false;
+
+	int first = -1;
+	forEachCell(m_shipMask[shipId], [&](int cell) {
+		if (first < 0)
+			first = cell;
+	});
+
+	topOrLeft = Point(first / m_cols, first % m_cols);
+	dir = (m_game.shipLength(shipId) == 1 ||
+		(m_cols > 1 && m_shipMask[shipId].test(first + 1))) ? HORIZONTAL : VERTICAL;
+	return true;
+}
+
+
+//*********************************************************************
+//  SparseBoardImpl
+//*********************************************************************
+
+//A TileSet is a set of cells stored as 8x8 tiles of 64 bits,
+//with only the tiles that hold at least one cell allocated.
+
+class TileSet
+{
+  public:
+	TileSet(int cols) : m_tilesPerRow((cols + 7) / 8) {}
+
+	bool test(int r, int c) const
+	{
+		unordered_map<int, uint64_t>::const_iterator it = m_tiles.find(tileOf(r, c));
+		return it != m_tiles.end() && ((it->second >> bitOf(r, c)) & 1);
+	}
+	void set(int r, int c) { m_tiles[tileOf(r, c)] |= uint64_t(1) << bitOf(r, c); }
+	void setTile(int tileRow, int tileCol, uint64_t bits)
+	{
+		if (bits != 0)
+			m_tiles[tileRow * m_tilesPerRow + tileCol] |= bits;
+	}
+	void clear() { m_tiles.clear(); }
+
+  private:
+	int tileOf(int r, int c) const { return (r >> 3) * m_tilesPerRow + (c >> 3); }
+	static int bitOf(int r, int c) { return (r & 7) * 8 + (c & 7); }
+
+	int m_tilesPerRow;
+	unordered_map<int, uint64_t> m_tiles;
+};
+
+class SparseBoardImpl : public BoardImpl
+{
+  public:
+    SparseBoardImpl(const Game& g);
+    virtual void clear();
+    virtual void block();
+    virtual void unblock();
+    virtual bool placeShip(Point topOrLeft, int shipId, Direction dir);
+    virtual bool unplaceShip(Point topOrLeft, int shipId, Direction dir);
+    virtual const Game& game() const { return m_game; }
+    virtual void cellSymbols(char* cells, bool shotsOnly) const;
+    virtual bool attack(Point p, bool& shotHit, bool& shipDestroyed, int& shipId);
+    virtual bool allShipsDestroyed() const;
+    virtual bool shipPlacement(int shipId, Point& topOrLeft, Direction& dir) const;
+
+  private:
+	//Only the cells that hold a ship are recorded, each with
+	//the id of its ship, and each ship counts its cells that
+	//have not been hit yet.
+
+	struct Ship
+	{
+		Ship() : placed(false), dir(HORIZONTAL), cellsAfloat(0) {}
+		bool placed;
+		Point topOrLeft;
+		Direction dir;
+		int cellsAfloat;
+	};
+
+	vector<Ship> m_ships;
+	unordered_map<int, int> m_owner;
+	TileSet m_blocked;
+	TileSet m_shots;
+	int m_cellsAfloat;
+
+	int m_rows;
+	int m_cols;
+
+	int cellIndex(int r, int c) const { return r * m_cols + c; }
+	bool fits(Point topOrLeft, int length, Direction dir) const;
+	Point cellOf(Point topOrLeft, Direction dir, int k) const
+	{
+		return dir == HORIZONTAL ? Point(topOrLeft.r, topOrLeft.c + k)
+			: Point(topOrLeft.r + k, topOrLeft.c);
+	}
+
+    const Game& m_game;
+};
+
+SparseBoardImpl::SparseBoardImpl(const Game& g)
+ : m_ships(g.nShips()), m_blocked(g.cols()), m_shots(g.cols()),
+	m_cellsAfloat(0), m_rows(g.rows()), m_cols(g.cols()), m_game(g)
+{}
+
+bool SparseBoardImpl::fits(Point topOrLeft, int length, Direction dir) const
+{
+	if (!m_game.isValid(topOrLeft))
+		return false;
+	if (dir == HORIZONTAL)
+		return topOrLeft.c + length <= m_cols;
+	if (dir == VERTICAL)
+		return topOrLeft.r + length <= m_rows;
+	return false;
+}
+
+void SparseBoardImpl::clear()
+{
+	m_ships.assign(m_game.nShips(), Ship());
+	m_owner.clear();
+	m_blocked.clear();
+	m_shots.clear();
+	m_cellsAfloat = 0;
+}
+
+//Block cells with 50% probability, 64 cells per random draw.
+//Bits that would fall off the edge of the board are dropped.
+
+void SparseBoardImpl::block()
+{
+	Rng& rng = m_game.rng();
+
+	for (int tr = 0; tr * 8 < m_rows; tr++)
+	{
+		const int nRows = min(8, m_rows - tr * 8);
+
+		for (int tc = 0; tc * 8 < m_cols; tc++)
+		{
+			const int nCols = min(8, m_cols - tc * 8);
+			const uint64_t rowMask = (uint64_t(1) << nCols) - 1;
+
+			uint64_t onBoard = 0;
+			for (int r = 0; r < nRows; r++)
+				onBoard |= rowMask << (8 * r);
+
+			m_blocked.setTile(tr, tc, rng.next() & onBoard);
+		}
+	}
+}
+
+void SparseBoardImpl::unblock()
+{
+	m_blocked.clear();
+}
+
+bool SparseBoardImpl::placeShip(Point topOrLeft, int shipId, Direction dir)
+{
+	if (shipId < 0 || shipId >= m_game.nShips())
+		return false;
+
+	if (shipId >= static_cast<int>(m_ships.size()))
+		m_ships.resize(m_game.nShips());
+
+	if (m_ships[shipId].placed)
+		return false;
+
+	const int length = m_game.shipLength(shipId);
+	if (!fits(topOrLeft, length, dir))
+		return false;
+
+	for (int k = 0; k < length; k++)
+	{
+		Point p = cellOf(topOrLeft, dir, k);
+		if (m_owner.count(cellIndex(p.r, p.c)) != 0 ||
+			m_blocked.test(p.r, p.c) || m_shots.test(p.r, p.c))
+			return false;
+	}
+
+	for (int k = 0; k < length; k++)
+	{
+		Point p = cellOf(topOrLeft, dir, k);
+		m_owner[cellIndex(p.r, p.c)] = shipId;
+	}
+
+	Ship& ship = m_ships[shipId];
+	ship.placed = true;
+	ship.topOrLeft = topOrLeft;
+	ship.dir = dir;
+	ship.cellsAfloat = length;
+	m_cellsAfloat += length;
+
+	return true;
+}
+
+bool SparseBoardImpl::unplaceShip(Point topOrLeft, int shipId, Direction dir)
+{
+	if (shipId < 0 || shipId >= static_cast<int>(m_ships.size()))
+		return false;
+
+	Ship& ship = m_ships[shipId];
+	if (!ship.placed || ship.dir != dir ||
+		ship.topOrLeft.r != topOrLeft.r || ship.topOrLeft.c != topOrLeft.c)
+		return false;
+
+	const int length = m_game.shipLength(shipId);
+	for (int k = 0; k < length; k++)
+	{
+		Point p = cellOf(topOrLeft, dir, k);
+		m_owner.erase(cellIndex(p.r, p.c));
+	}
+
+	m_cellsAfloat -= ship.cellsAfloat;
+	ship = Ship();
+
+	return true;
+}
+
+//Drawing the board is the one thing that has to visit
+//every cell.
+
+void SparseBoardImpl::cellSymbols(char* cells, bool shotsOnly) const
+{
+	for (int k = 0; k < m_rows; k++)
+	{
+		for (int j = 0; j < m_cols; j++)
+		{
+			unordered_map<int, int>::const_iterator it = m_owner.find(cellIndex(k, j));
+			const bool occupied = (it != m_owner.end());
+			char& symbol = cells[cellIndex(k, j)];
+
+			if (m_shots.test(k, j))
+				symbol = (occupied ? 'X' : 'o');
+			else if (m_blocked.test(k, j))
+				symbol = 'o';
+			else if (occupied && !shotsOnly)
+				symbol = m_game.shipSymbol(it->second);
+			else
+				symbol = '.';
+		}
+	}
+}
+
+bool SparseBoardImpl::attack(Point p, bool& shotHit, bool& shipDestroyed, int& shipId)
+{
+	shotHit = false;
+	shipDestroyed = false;
+
+	if (!m_game.isValid(p))
+		return false;
+
+	if (m_shots.test(p.r, p.c) || m_blocked.test(p.r, p.c))
+		return false;
+
+	m_shots.set(p.r, p.c);
+
+	unordered_map<int, int>::const_iterator it = m_owner.find(cellIndex(p.r, p.c));
+	if (it == m_owner.end())
+		return true;
+
+	shotHit = true;
+	m_cellsAfloat--;
+
+	if (--m_ships[it->second].cellsAfloat == 0)
+	{
+		shipDestroyed = true;
+		shipId = it->second;
+	}
+
+	return true;
+}
+
+bool SparseBoardImpl::allShipsDestroyed() const
+{
+	return m_cellsAfloat == 0;
+}
+
+bool SparseBoardImpl::shipPlacement(int shipId, Point& topOrLeft, Direction& dir) const
+{
+	if (shipId < 0 || shipId >= static_cast<int>(m_ships.size()) ||
+		!m_ships[shipId].placed)
+		return false;
+
+	topOrLeft = m_ships[shipId].topOrLeft;
+	dir = m_ships[shipId].dir;
+	return true;
+}
+
+//******************** Board functions ********************************
+
+// These functions simply delegate to BoardImpl's functions.
+// You probably don't want to change any of this code.
+
+Board::Board(const Game& g)
+{
+    if (FixedBoardImpl<10, 10, StandardFleet>::matches(g))
+        m_impl = new FixedBoardImpl<10, 10, StandardFleet>(g);
+    else if (PlacementTable::fits(g.rows(), g.cols()))
+        m_impl = new BitboardImpl(g);
+    else
+        m_impl = new SparseBoardImpl(g);
+}
+
+Board::~Board()
+{
+    delete m_impl;
+}
+
+void Board::clear()
+{
+    m_impl->clear();
+}
+
+void Board::block()
+{
+    return m_impl->block();
+}
+
+void Board::unblock()
+{
+    return m_impl->unblock();
+}
+
+bool Board::placeShip(Point topOrLeft, int shipId, Direction dir)
+{
+    return m_impl->placeShip(topOrLeft, shipId, dir);
+}
+
+bool Board::unplaceShip(Point topOrLeft, int shipId, Direction dir)
+{
+    return m_impl->unplaceShip(topOrLeft, shipId, dir);
+}
+
+void Board::display(bool shotsOnly) const
+{
+    static thread_local BoardRenderer renderer;
+    renderer.draw(m_impl->game(), *this, shotsOnly);
+}
+
+void Board::cellSymbols(char* cells, bool shotsOnly) const
+{
+    m_impl->cellSymbols(cells, shotsOnly);
+}
+
+bool Board::attack(Point p, bool& shotHit, bool& shipDestroyed, int& shipId)
+{
+    return m_impl->attack(p, shotHit, shipDestroyed, shipId);
+}
+
+bool Board::allShipsDestroyed() const
+{
+    return m_impl->allShipsDestroyed();
+}
+
+bool Board::shipPlacement(int shipId, Point& topOrLeft, Direction& dir) const
+{
+    return m_impl->shipPlacement(shipId, topOrLeft, dir);
 }
\ No newline at end of file
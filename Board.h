@@ -18,8 +18,13 @@ public:
     bool placeShip(Point topOrLeft, int shipId, Direction dir);
     bool unplaceShip(Point topOrLeft, int shipId, Direction dir);
     void display(bool shotsOnly) const;
+      // What display shows in each cell, row by row, into
+      // cells[0] through cells[rows * cols - 1]
+    void cellSymbols(char* cells, bool shotsOnly) const;
     bool attack(Point p, bool& shotHit, bool& shipDestroyed, int& shipId);
     bool allShipsDestroyed() const;
+      // The position of the ship; false if it is not on the board
+    bool shipPlacement(int shipId, Point& topOrLeft, Direction& dir) const;
     Board(const Board&) = delete;
     Board& operator=(const Board&) = delete;
     
@@ -0,0 +1,159 @@
+#include "BoardRenderer.h"
+#include "Board.h"
+#include "Game.h"
+#include <iostream>
+#include <cstdlib>
+#include <cstring>
+
+using namespace std;
+
+//A panel is its caption, the column numbers, the rows and a
+//blank line
+
+static int panelLines(int rows)
+{
+	return rows + 3;
+}
+
+static void appendInt(string& out, int v)
+{
+	char digits[12];
+	int n = 0;
+	do
+	{
+		digits[n++] = static_cast<char>('0' + v % 10);
+		v /= 10;
+	} while (v > 0);
+	while (n > 0)
+		out += digits[--n];
+}
+
+static int widthOf(int v)
+{
+	int n = 1;
+	for (; v >= 10; v /= 10)
+		n++;
+	return n;
+}
+
+BoardRenderer::BoardRenderer(Mode mode)
+ : m_mode(mode), m_rows(0), m_cols(0)
+{}
+
+BoardRenderer::Mode BoardRenderer::defaultMode()
+{
+	const char* display = getenv("BATTLESHIP_DISPLAY");
+	return display != nullptr && strcmp(display, "diff") == 0 ? ANSI_DIFF : PLAIN;
+}
+
+void BoardRenderer::draw(const Game& g, const Board& b, bool shotsOnly,
+	const string& caption)
+{
+	if (g.rows() != m_rows || g.cols() != m_cols)
+	{
+		m_rows = g.rows();
+		m_cols = g.cols();
+		m_panels.clear();
+	}
+	m_cells.resize(static_cast<size_t>(m_rows) * m_cols);
+	b.cellSymbols(m_cells.data(), shotsOnly);
+	m_frame.clear();
+
+	if (m_mode == PLAIN)
+		formatWhole(caption, !caption.empty());
+	else
+	{
+		size_t k = 0;
+		while (k < m_panels.size() && m_panels[k].board != &b)
+			k++;
+
+		if (k < m_panels.size())
+			formatChanges(m_panels[k], caption);
+		else
+		{
+			//A new board, most likely of a new game, once the
+			//panels are full
+
+			if (m_panels.size() == RENDERER_PANELS)
+				m_panels.clear();
+			Panel panel;
+			panel.board = &b;
+			panel.top = 1 + static_cast<int>(m_panels.size()) * panelLines(m_rows);
+			panel.caption = caption;
+			panel.shown = m_cells;
+			m_panels.push_back(panel);
+
+			if (m_panels.size() == 1)
+				m_frame += "\x1b[H\x1b[2J";
+			else
+				moveTo(panel.top, 1);
+			formatWhole(caption, true);
+		}
+
+		moveTo(1 + static_cast<int>(m_panels.size()) * panelLines(m_rows), 1);
+		m_frame += "\x1b[J";
+	}
+
+	cout.write(m_frame.data(), m_frame.size());
+	cout.flush();
+}
+
+void BoardRenderer::formatWhole(const string& caption, bool captionLine)
+{
+	if (captionLine)
+	{
+		m_frame += caption;
+		m_frame += '\n';
+	}
+
+	m_frame += "  ";
+	for (int k = 0; k < m_cols; k++)
+		appendInt(m_frame, k);
+	m_frame += '\n';
+
+	for (int k = 0; k < m_rows; k++)
+	{
+		appendInt(m_frame, k);
+		m_frame += ' ';
+		m_frame.append(&m_cells[static_cast<size_t>(k) * m_cols], m_cols);
+		m_frame += '\n';
+	}
+}
+
+//A run of changed cells in a row needs only one cursor move
+
+void BoardRenderer::formatChanges(Panel& panel, const string& caption)
+{
+	if (caption != panel.caption)
+	{
+		moveTo(panel.top, 1);
+		m_frame += caption;
+		m_frame += "\x1b[K";
+		panel.caption = caption;
+	}
+
+	for (int k = 0; k < m_rows; k++)
+	{
+		const size_t row = static_cast<size_t>(k) * m_cols;
+		int next = -1;    // where the cursor is in this row, if known
+		for (int j = 0; j < m_cols; j++)
+		{
+			if (m_cells[row + j] == panel.shown[row + j])
+				continue;
+			if (j != next)
+				moveTo(panel.top + 2 + k, widthOf(k) + 2 + j);
+			m_frame += m_cells[row + j];
+			panel.shown[row + j] = m_cells[row + j];
+			next = j + 1;
+		}
+	}
+}
+
+void BoardRenderer::moveTo(int line, int column)
+{
+	m_frame += "\x1b[";
+	appendInt(m_frame, line);
+	m_frame += ';';
+	appendInt(m_frame, column);
+	m_frame += 'H';
+}
@@ -0,0 +1,67 @@
+
+#ifndef BOARDRENDERER_INCLUDED
+#define BOARDRENDERER_INCLUDED
+
+#include <string>
+#include <vector>
+
+class Game;
+class Board;
+
+// A BoardRenderer draws boards to cout the way Board::display always has:
+// a line of column numbers, then each row after its number.  It formats
+// the whole frame into a buffer it keeps from frame to frame and hands it
+// to cout in one write.
+//
+// In ANSI_DIFF mode each board gets a panel of its own at the top of the
+// screen, under a caption line, so both boards of a game stay in view.
+// A board seen for the first time is drawn whole below the others (the
+// first one after clearing the screen); after that only the cells and
+// caption that changed since the board was last drawn are redrawn, using
+// ANSI cursor moves.  The cursor is left on the line below the panels,
+// and everything below it is cleared.
+
+const int RENDERER_PANELS = 2;
+
+class BoardRenderer
+{
+public:
+    enum Mode { PLAIN, ANSI_DIFF };
+
+    explicit BoardRenderer(Mode mode = PLAIN);
+
+    Mode mode() const { return m_mode; }
+
+      // Draw b, a board of g, after caption if it is not empty
+    void draw(const Game& g, const Board& b, bool shotsOnly,
+              const std::string& caption = std::string());
+
+      // Forget what is on the screen, so the next frame starts afresh
+    void reset() { m_panels.clear(); }
+
+      // ANSI_DIFF if the environment variable BATTLESHIP_DISPLAY is
+      // "diff", else PLAIN
+    static Mode defaultMode();
+
+private:
+    struct Panel
+    {
+        const Board* board;
+        int top;                   // the line of the caption
+        std::string caption;
+        std::vector<char> shown;   // the cells as they are on the screen
+    };
+
+    void formatWhole(const std::string& caption, bool captionLine);
+    void formatChanges(Panel& panel, const std::string& caption);
+    void moveTo(int line, int column);
+
+    Mode m_mode;
+    std::string m_frame;
+    std::vector<char> m_cells;
+    int m_rows;
+    int m_cols;
+    std::vector<Panel> m_panels;
+};
+
+#endif // BOARDRENDERER_INCLUDED
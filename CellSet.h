@@ -0,0 +1,53 @@
+
+#ifndef CELLSET_INCLUDED
+#define CELLSET_INCLUDED
+
+#include "globals.h"
+#include <vector>
+
+// A CellSet is a set of board cells, each named by its index r * cols + c.
+// Members are kept packed in an array with a reverse index beside it, so
+// insert, erase, membership and drawing a uniformly random member are all
+// O(1) however full the set is.
+
+class CellSet
+{
+public:
+    explicit CellSet(int nCells = 0) : m_pos(nCells, -1) {}
+
+    int size() const { return static_cast<int>(m_cells.size()); }
+    bool empty() const { return m_cells.empty(); }
+    int at(int k) const { return m_cells[k]; }
+
+    bool contains(int cell) const { return m_pos[cell] >= 0; }
+
+    void insert(int cell)
+    {
+        if (m_pos[cell] >= 0)
+            return;
+        m_pos[cell] = size();
+        m_cells.push_back(cell);
+    }
+
+      // The last member moves into the erased member's slot
+    void erase(int cell)
+    {
+        const int k = m_pos[cell];
+        if (k < 0)
+            return;
+        const int last = m_cells.back();
+        m_cells[k] = last;
+        m_pos[last] = k;
+        m_cells.pop_back();
+        m_pos[cell] = -1;
+    }
+
+      // The set must not be empty
+    int sample(Rng& rng) const { return m_cells[rng.randInt(size())]; }
+
+private:
+    std::vector<int> m_cells;
+    std::vector<int> m_pos;  // index into m_cells, or -1 if absent
+};
+
+#endif // CELLSET_INCLUDED
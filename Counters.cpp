@@ -0,0 +1,109 @@
+#include "Counters.h"
+
+using namespace std;
+
+void StrategyCounters::clear()
+{
+	attackCalls = 0;
+	candidateDraws = 0;
+	rangeWidenings = 0;
+	escapes = 0;
+	unfiredFallbacks = 0;
+	fleetSamples = 0;
+	rejectedSamples = 0;
+	endgameFleets = 0;
+	tableProbes = 0;
+	tableHits = 0;
+	blockRounds = 0;
+	placementTries = 0;
+	solverCalls = 0;
+	solverNodes = 0;
+	solverBacktracks = 0;
+	solverMaxDepth = 0;
+	solverMaxNodes = 0;
+}
+
+static void keepMax(long long& a, long long b)
+{
+	if (b > a)
+		a = b;
+}
+
+void StrategyCounters::add(const StrategyCounters& other)
+{
+	attackCalls += other.attackCalls;
+	candidateDraws += other.candidateDraws;
+	rangeWidenings += other.rangeWidenings;
+	escapes += other.escapes;
+	unfiredFallbacks += other.unfiredFallbacks;
+	fleetSamples += other.fleetSamples;
+	rejectedSamples += other.rejectedSamples;
+	endgameFleets += other.endgameFleets;
+	tableProbes += other.tableProbes;
+	tableHits += other.tableHits;
+	blockRounds += other.blockRounds;
+	placementTries += other.placementTries;
+	solverCalls += other.solverCalls;
+	solverNodes += other.solverNodes;
+	solverBacktracks += other.solverBacktracks;
+
+	//Maxima stay maxima when games are added up
+
+	keepMax(solverMaxDepth, other.solverMaxDepth);
+	keepMax(solverMaxNodes, other.solverMaxNodes);
+}
+
+void StrategyCounters::takeMax(const StrategyCounters& other)
+{
+	keepMax(attackCalls, other.attackCalls);
+	keepMax(candidateDraws, other.candidateDraws);
+	keepMax(rangeWidenings, other.rangeWidenings);
+	keepMax(escapes, other.escapes);
+	keepMax(unfiredFallbacks, other.unfiredFallbacks);
+	keepMax(fleetSamples, other.fleetSamples);
+	keepMax(rejectedSamples, other.rejectedSamples);
+	keepMax(endgameFleets, other.endgameFleets);
+	keepMax(tableProbes, other.tableProbes);
+	keepMax(tableHits, other.tableHits);
+	keepMax(blockRounds, other.blockRounds);
+	keepMax(placementTries, other.placementTries);
+	keepMax(solverCalls, other.solverCalls);
+	keepMax(solverNodes, other.solverNodes);
+	keepMax(solverBacktracks, other.solverBacktracks);
+	keepMax(solverMaxDepth, other.solverMaxDepth);
+	keepMax(solverMaxNodes, other.solverMaxNodes);
+}
+
+long long StrategyCounters::work() const
+{
+	return candidateDraws + rangeWidenings + blockRounds + placementTries +
+		solverNodes + fleetSamples + endgameFleets;
+}
+
+void CounterStats::record(const StrategyCounters& c, long long gameNumber)
+{
+	games++;
+	total.add(c);
+	peak.takeMax(c);
+	if (c.work() > worstWork)
+	{
+		worstWork = c.work();
+		worstGame = gameNumber;
+	}
+}
+
+//Ties on the worst game go to the lower game number, so the
+//result does not depend on how games were shared out
+
+void CounterStats::merge(const CounterStats& other)
+{
+	games += other.games;
+	total.add(other.total);
+	peak.takeMax(other.peak);
+	if (other.worstWork > worstWork ||
+		(other.worstWork == worstWork && other.worstGame < worstGame))
+	{
+		worstWork = other.worstWork;
+		worstGame = other.worstGame;
+	}
+}
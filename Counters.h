@@ -0,0 +1,67 @@
+
+#ifndef COUNTERS_INCLUDED
+#define COUNTERS_INCLUDED
+
+#include <cstdint>
+
+// Counters of the work the computer players do, for finding the board states
+// that make a move slow.  Each Game keeps one set for the game being played,
+// and a match adds them up.  They are only kept when the program is built
+// with BATTLESHIP_COUNTERS defined; otherwise BATTLESHIP_COUNT compiles to
+// nothing and every counter stays 0.
+
+struct StrategyCounters
+{
+    StrategyCounters() { clear(); }
+    void clear();
+    void add(const StrategyCounters& other);
+    void takeMax(const StrategyCounters& other);
+    long long work() const;  // a rough total, for ranking games
+
+      // recommendAttack
+    long long attackCalls;        // moves asked of the computer players
+    long long candidateDraws;     // random draws from a set of candidate cells
+    long long rangeWidenings;     // times the range around a first hit grew
+    long long escapes;            // times hunting ran out of parity cells
+    long long unfiredFallbacks;   // moves drawn from every unfired cell
+    long long fleetSamples;       // fleets drawn by sampling players
+    long long rejectedSamples;    // of those, draws that hit a dead end
+    long long endgameFleets;      // fleets listed by the endgame solver
+    long long tableProbes;        // transposition table lookups
+    long long tableHits;          // of those, states found with a usable move
+
+      // placeShips
+    long long blockRounds;        // blocked-cell sets drawn before a placement solved
+    long long placementTries;     // random positions tried for a single ship
+    long long solverCalls;
+    long long solverNodes;        // partial placements the solver extended
+    long long solverBacktracks;   // partial placements it gave up on
+    long long solverMaxDepth;     // most ships ever placed at once in a search
+    long long solverMaxNodes;     // nodes in the largest single search
+};
+
+// Counters over many games
+
+struct CounterStats
+{
+    CounterStats() : games(0), worstGame(0), worstWork(-1) {}
+    void record(const StrategyCounters& c, long long gameNumber);
+    void merge(const CounterStats& other);
+
+    long long games;
+    StrategyCounters total;
+    StrategyCounters peak;     // the largest value of each counter in one game
+    long long worstGame;       // the game with the most work, by number
+    long long worstWork;
+};
+
+#ifdef BATTLESHIP_COUNTERS
+#define BATTLESHIP_COUNT(g, field, n) ((g).counters().field += (n))
+#define BATTLESHIP_COUNT_MAX(g, field, v) \
+    ((g).counters().field < (v) ? (void)((g).counters().field = (v)) : (void)0)
+#else
+#define BATTLESHIP_COUNT(g, field, n) ((void)0)
+#define BATTLESHIP_COUNT_MAX(g, field, v) ((void)0)
+#endif
+
+#endif // COUNTERS_INCLUDED
@@ -0,0 +1,193 @@
+#include "DensityMap.h"
+#include "PlacementTable.h"
+#include "Game.h"
+
+using namespace std;
+
+DensityMap::DensityMap(const Game& g)
+ : m_table(PlacementTable::forGame(g)), m_nCells(g.rows() * g.cols()),
+	m_key(m_nCells, 0)
+{
+	const int nClasses = m_table->nLengthClasses();
+	m_classShip.assign(nClasses, -1);
+	m_afloat.assign(nClasses, 0);
+
+	for (int s = 0; s < g.nShips(); s++)
+	{
+		const int cls = m_table->lengthClass(s);
+		if (m_classShip[cls] < 0)
+			m_classShip[cls] = s;
+		m_afloat[cls]++;
+	}
+
+	m_alive.resize(nClasses);
+	m_hitCount.resize(nClasses);
+	m_classCover.resize(nClasses);
+	m_classTarget.resize(nClasses);
+
+	for (int cls = 0; cls < nClasses; cls++)
+	{
+		const int ship = m_classShip[cls];
+		m_alive[cls].assign(m_table->count(ship), 1);
+		m_hitCount[cls].assign(m_table->count(ship), 0);
+		m_classCover[cls].resize(m_nCells);
+		m_classTarget[cls].assign(m_nCells, 0);
+
+		for (int cell = 0; cell < m_nCells; cell++)
+		{
+			m_classCover[cls][cell] = m_table->coveringCount(ship, cell);
+			m_key[cell] += static_cast<long long>(m_afloat[cls]) *
+				m_classCover[cls][cell];
+		}
+	}
+}
+
+bool DensityMap::isLive(int shipId, int k) const
+{
+	return m_alive[m_table->lengthClass(shipId)][k] != 0;
+}
+
+//Take a placement out of the counts for good
+
+void DensityMap::kill(int cls, int k)
+{
+	m_alive[cls][k] = 0;
+
+	const int w = weight(m_hitCount[cls][k]);
+	const long long change = m_afloat[cls] * ((static_cast<long long>(w) << DENSITY_BITS) + 1);
+	vector<int>& cover = m_classCover[cls];
+	vector<int>& target = m_classTarget[cls];
+
+	forEachCell(m_table->mask(m_classShip[cls], k), [&](int cell) {
+		cover[cell]--;
+		target[cell] -= w;
+		m_key[cell] -= change;
+	});
+}
+
+void DensityMap::recordMiss(int cell)
+{
+	m_key[cell] -= FIRED;
+
+	for (size_t cls = 0; cls < m_classShip.size(); cls++)
+	{
+		const int ship = m_classShip[cls];
+		const int* k = m_table->covering(ship, cell);
+		const int* end = k + m_table->coveringCount(ship, cell);
+		for ( ; k != end; k++)
+			if (m_alive[cls][*k])
+				kill(cls, *k);
+	}
+}
+
+void DensityMap::recordHit(int cell)
+{
+	m_key[cell] -= FIRED;
+	m_openHits.set(cell);
+
+	for (size_t cls = 0; cls < m_classShip.size(); cls++)
+	{
+		const int ship = m_classShip[cls];
+		const long long afloat = m_afloat[cls];
+		vector<int>& target = m_classTarget[cls];
+
+		const int* k = m_table->covering(ship, cell);
+		const int* end = k + m_table->coveringCount(ship, cell);
+		for ( ; k != end; k++)
+		{
+			if (!m_alive[cls][*k])
+				continue;
+
+			const int before = weight(m_hitCount[cls][*k]++);
+			const int delta = weight(m_hitCount[cls][*k]) - before;
+			const long long change = (afloat * delta) << DENSITY_BITS;
+			forEachCell(m_table->mask(ship, *k), [&](int c) {
+				target[c] += delta;
+				m_key[c] += change;
+			});
+		}
+	}
+}
+
+//The cell holds part of a sunk ship, so no other ship can
+//be there, and its hit no longer needs explaining.
+
+void DensityMap::resolve(int cell)
+{
+	m_openHits.reset(cell);
+
+	for (size_t cls = 0; cls < m_classShip.size(); cls++)
+	{
+		const int ship = m_classShip[cls];
+		const int* k = m_table->covering(ship, cell);
+		const int* end = k + m_table->coveringCount(ship, cell);
+		for ( ; k != end; k++)
+			if (m_alive[cls][*k])
+				kill(cls, *k);
+	}
+}
+
+//The sunk ship lies on some placement of its length through
+//the sinking cell whose cells are all open hits. Every cell
+//that all such placements share is certainly part of it.
+
+void DensityMap::recordSink(int cell, int shipId)
+{
+	const int cls = m_table->lengthClass(shipId);
+	const int ship = m_classShip[cls];
+
+	Bitboard sunk;
+	bool found = false;
+
+	const int* k = m_table->covering(ship, cell);
+	const int* end = k + m_table->coveringCount(ship, cell);
+	for ( ; k != end; k++)
+	{
+		const Bitboard& mask = m_table->mask(ship, *k);
+		if (!m_alive[cls][*k] || !mask.isSubsetOf(m_openHits))
+			continue;
+		if (!found)
+			sunk = mask;
+		else
+			sunk &= mask;
+		found = true;
+	}
+	if (!found)
+		sunk.set(cell);
+
+	//One fewer ship of the class is left to be counted
+
+	const vector<int>& cover = m_classCover[cls];
+	const vector<int>& target = m_classTarget[cls];
+	for (int c = 0; c < m_nCells; c++)
+		m_key[c] -= (static_cast<long long>(target[c]) << DENSITY_BITS) + cover[c];
+	m_afloat[cls]--;
+
+	forEachCell(sunk, [&](int c) { resolve(c); });
+}
+
+//The target density decides, and the plain density breaks
+//ties. Once no hit is open, no live placement covers an open
+//hit, so the target density is 0 everywhere.
+
+int DensityMap::bestCell(Rng& rng) const
+{
+	const long long* key = m_key.data();
+
+	long long bestKey = -1;
+	for (int cell = 0; cell < m_nCells; cell++)
+		bestKey = key[cell] > bestKey ? key[cell] : bestKey;
+	if (bestKey < 0)
+		return -1;
+
+	int ties = 0;
+	for (int cell = 0; cell < m_nCells; cell++)
+		ties += (key[cell] == bestKey);
+
+	//Take the j-th of the cells that tie for the best
+
+	int j = ties > 1 ? rng.randInt(ties) : 0;
+	for (int cell = 0; ; cell++)
+		if (key[cell] == bestKey && j-- == 0)
+			return cell;
+}
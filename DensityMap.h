@@ -0,0 +1,82 @@
+
+#ifndef DENSITYMAP_INCLUDED
+#define DENSITYMAP_INCLUDED
+
+#include "globals.h"
+#include "Bitboard.h"
+#include <vector>
+#include <memory>
+
+class Game;
+class PlacementTable;
+
+// A DensityMap counts, for every cell, the placements of the ships still
+// afloat that agree with the shots fired so far: no placement may cover a
+// miss or a cell of a sunk ship.  A shot only visits the placements that
+// cover its cell, through the PlacementTable's index of them, so keeping
+// the counts up to date takes a few hundred steps per shot.
+//
+// Hits not yet put down to a sunk ship are "open".  A placement covering h
+// open hits adds a weight that grows steeply with h to a second, target
+// density, which decides the next shot while any hit is open.
+
+class DensityMap
+{
+public:
+      // The board must fit in a PlacementTable
+    DensityMap(const Game& g);
+
+    void recordMiss(int cell);
+    void recordHit(int cell);
+      // The shot at cell, already recorded as a hit, sank the ship
+    void recordSink(int cell, int shipId);
+
+    bool hasOpenHits() const { return m_openHits.any(); }
+    const Bitboard& openHits() const { return m_openHits; }
+
+      // True if placement k of the ship (an index into the table's masks)
+      // agrees with every shot so far
+    bool isLive(int shipId, int k) const;
+      // Only meaningful for cells not yet fired at
+    long long density(int cell) const { return m_key[cell] & (DENSITY_LIMIT - 1); }
+    long long targetDensity(int cell) const { return m_key[cell] >> DENSITY_BITS; }
+
+      // The unfired cell most likely to hold a ship, ties broken at
+      // random, or -1 if every cell has been fired at
+    int bestCell(Rng& rng) const;
+
+private:
+    static int weight(int openHits)
+    {
+        return openHits == 0 ? 0 : 1 << (4 * (openHits < 7 ? openHits - 1 : 6));
+    }
+      // A cell's density is at most 2 * 256, so it fits below the lowest
+      // bit of its target density in a single key
+    static const int DENSITY_BITS = 10;
+    static const long long DENSITY_LIMIT = 1LL << DENSITY_BITS;
+      // Taken off the key of a cell once it is fired at, so that it never
+      // again looks like the best cell
+    static const long long FIRED = 1LL << 60;
+
+    void kill(int cls, int k);
+    void resolve(int cell);
+
+    std::shared_ptr<const PlacementTable> m_table;
+    int m_nCells;
+
+      // Per length class
+    std::vector<int> m_classShip;          // a ship of the class
+    std::vector<int> m_afloat;             // ships of the class still afloat
+    std::vector< std::vector<char> > m_alive;      // per placement
+    std::vector< std::vector<int> > m_hitCount;    // open hits under each placement
+    std::vector< std::vector<int> > m_classCover;  // live placements over each cell
+    std::vector< std::vector<int> > m_classTarget; // their weights, over each cell
+
+      // The class counts above, times the ships of the class still afloat
+      // and summed over the classes, as target << DENSITY_BITS | density
+    std::vector<long long> m_key;
+
+    Bitboard m_openHits;
+};
+
+#endif // DENSITYMAP_INCLUDED
@@ -0,0 +1,282 @@
+#include "EndgameSolver.h"
+#include "PlacementTable.h"
+#include "Game.h"
+#include "Counters.h"
+#include <algorithm>
+
+using namespace std;
+
+EndgameSolver::EndgameSolver(const Game& g)
+ : m_game(g), m_table(PlacementTable::forGame(g)), m_nCells(g.rows() * g.cols()),
+	m_afloat(g.nShips(), true), m_sunkPlacements(g.nShips()), m_solved(false)
+{
+	const int nClasses = m_table->nLengthClasses();
+	m_clear.resize(nClasses);
+	m_clearCount.resize(nClasses);
+	m_classShip.resize(nClasses);
+	for (int s = 0; s < g.nShips(); s++)
+	{
+		const int cls = m_table->lengthClass(s);
+		const int count = m_table->count(s);
+		m_clear[cls].assign(m_table->coverWords(s), ~uint64_t(0));
+		if (count % 64 != 0)
+			m_clear[cls].back() = (uint64_t(1) << (count % 64)) - 1;
+		m_clearCount[cls] = count;
+		m_classShip[cls] = s;
+	}
+}
+
+bool EndgameSolver::solve()
+{
+	if (m_solved)
+		return !m_fleetCells.empty();
+
+	//The product of the candidate counts bounds the number of
+	//fleets
+
+	long long bound = 1;
+	bool anyAfloat = false;
+	for (size_t s = 0; s < m_afloat.size(); s++)
+	{
+		if (m_afloat[s])
+		{
+			anyAfloat = true;
+			bound *= m_clearCount[m_table->lengthClass(static_cast<int>(s))];
+		}
+		else
+			bound *= static_cast<long long>(m_sunkPlacements[s].size());
+		if (bound > ENDGAME_LIMIT)
+			return false;
+	}
+	if (!anyAfloat)
+		return false;
+
+	enumerate(bound);
+	m_solved = true;
+	count();
+	return !m_fleetCells.empty();
+}
+
+//A ship afloat may be on any placement that covers no miss
+//and is not wholly hit, since then it would have been reported
+//sunk. A sunk ship is on one of the placements it had when it
+//sank. Overlaps with sunk ships are left to the search.
+
+void EndgameSolver::candidates(int shipId, vector<int>& live) const
+{
+	if (!m_afloat[shipId])
+	{
+		live = m_sunkPlacements[shipId];
+		return;
+	}
+
+	const vector<uint64_t>& clear = m_clear[m_table->lengthClass(shipId)];
+	live.clear();
+	for (size_t w = 0; w < clear.size(); w++)
+	{
+		for (uint64_t bits = clear[w]; bits != 0; bits &= bits - 1)
+		{
+			const int k = static_cast<int>(w * 64) + lowestBit(bits);
+			if (!m_table->mask(shipId, k).isSubsetOf(m_hits))
+				live.push_back(k);
+		}
+	}
+}
+
+//Ships with the fewest candidates are placed first
+
+void EndgameSolver::enumerate(long long bound)
+{
+	const int n = static_cast<int>(m_afloat.size());
+	vector< vector<int> > live(n);
+	for (int s = 0; s < n; s++)
+		candidates(s, live[s]);
+
+	m_ships.clear();
+	for (int s = 0; s < n; s++)
+		m_ships.push_back(s);
+	stable_sort(m_ships.begin(), m_ships.end(), [&](int a, int b) {
+		return live[a].size() < live[b].size();
+	});
+
+	m_live.assign(n, vector<int>());
+	m_lengthLeft.assign(n + 1, 0);
+	m_chosen.assign(n, -1);
+	for (int j = n - 1; j >= 0; j--)
+	{
+		m_live[j].swap(live[m_ships[j]]);
+		m_lengthLeft[j] = m_lengthLeft[j + 1] + m_table->shipLength(m_ships[j]);
+	}
+
+	m_fleetCells.clear();
+	m_fleetPlacements.clear();
+	m_fleetCells.reserve(bound);
+	m_fleetPlacements.reserve(bound * n);
+	search(0, Bitboard());
+}
+
+//Every hit must be covered by the fleet. A branch ends as soon
+//as the ships still to be placed are too short to cover the
+//hits left uncovered.
+
+void EndgameSolver::search(int depth, const Bitboard& used)
+{
+	Bitboard uncovered = m_hits;
+	uncovered.andNot(used);
+	if (depth == static_cast<int>(m_ships.size()))
+	{
+		if (uncovered.none())
+		{
+			BATTLESHIP_COUNT(m_game, endgameFleets, 1);
+			m_fleetCells.push_back(used);
+			for (int j = 0; j < depth; j++)
+				m_fleetPlacements.push_back(static_cast<int16_t>(m_chosen[j]));
+		}
+		return;
+	}
+
+	if (uncovered.count() > m_lengthLeft[depth])
+		return;
+
+	const int s = m_ships[depth];
+	const vector<int>& live = m_live[depth];
+
+	for (size_t k = 0; k < live.size(); k++)
+	{
+		const Bitboard& mask = m_table->mask(s, live[k]);
+		if (mask.intersects(used))
+			continue;
+		m_chosen[depth] = live[k];
+		search(depth + 1, used | mask);
+	}
+}
+
+//A fleet agrees with a miss if no ship covers the cell. With
+//a hit, the ship that covers the cell must have been sunk by
+//it if and only if all its cells are now hit.
+
+bool EndgameSolver::agrees(int fleet, int cell, bool shotHit, int sunkShip) const
+{
+	if (!m_fleetCells[fleet].test(cell))
+		return !shotHit;
+	if (!shotHit)
+		return false;
+
+	const int n = static_cast<int>(m_ships.size());
+	for (int j = 0; j < n; j++)
+	{
+		const Bitboard& mask = m_table->mask(m_ships[j], m_fleetPlacements[fleet * n + j]);
+		if (!mask.test(cell))
+			continue;
+		const bool allHit = mask.isSubsetOf(m_hits);
+		return sunkShip < 0 ? !allHit : (m_ships[j] == sunkShip && allHit);
+	}
+
+	return false;
+}
+
+void EndgameSolver::record(int cell, bool shotHit, int sunkShip)
+{
+	m_fired.set(cell);
+	if (shotHit)
+		m_hits.set(cell);
+	else
+	{
+		for (size_t cls = 0; cls < m_clear.size(); cls++)
+		{
+			const uint64_t* covered = m_table->coverBits(m_classShip[cls], cell);
+			vector<uint64_t>& clear = m_clear[cls];
+			int count = 0;
+			for (size_t w = 0; w < clear.size(); w++)
+			{
+				clear[w] &= ~covered[w];
+				count += popCount(clear[w]);
+			}
+			m_clearCount[cls] = count;
+		}
+	}
+	if (sunkShip >= 0)
+	{
+		m_afloat[sunkShip] = false;
+		const int* k = m_table->covering(sunkShip, cell);
+		const int* end = k + m_table->coveringCount(sunkShip, cell);
+		for ( ; k != end; k++)
+			if (m_table->mask(sunkShip, *k).isSubsetOf(m_hits))
+				m_sunkPlacements[sunkShip].push_back(*k);
+	}
+
+	if (!m_solved)
+		return;
+
+	//Keep the fleets that agree, in their order, taking those
+	//that do not out of the counts
+
+	const int n = static_cast<int>(m_ships.size());
+	size_t kept = 0;
+
+	for (size_t f = 0; f < m_fleetCells.size(); f++)
+	{
+		if (!agrees(static_cast<int>(f), cell, shotHit, sunkShip))
+		{
+			Bitboard unfired = m_fleetCells[f];
+			unfired.andNot(m_fired);
+			forEachCell(unfired, [&](int c) { m_counts[c]--; });
+			continue;
+		}
+		if (kept != f)
+		{
+			m_fleetCells[kept] = m_fleetCells[f];
+			for (int j = 0; j < n; j++)
+				m_fleetPlacements[kept * n + j] = m_fleetPlacements[f * n + j];
+		}
+		kept++;
+	}
+
+	m_fleetCells.resize(kept);
+	m_fleetPlacements.resize(kept * n);
+	m_counts[cell] = 0;
+}
+
+//Only done once, when the fleets are first listed; after that
+//record keeps the counts up to date
+
+void EndgameSolver::count()
+{
+	m_counts.assign(m_nCells, 0);
+	for (size_t f = 0; f < m_fleetCells.size(); f++)
+	{
+		Bitboard unfired = m_fleetCells[f];
+		unfired.andNot(m_fired);
+		forEachCell(unfired, [&](int cell) { m_counts[cell]++; });
+	}
+}
+
+double EndgameSolver::probability(int cell) const
+{
+	if (m_fleetCells.empty())
+		return 0;
+	return static_cast<double>(m_counts[cell]) / m_fleetCells.size();
+}
+
+int EndgameSolver::bestCell(Rng& rng) const
+{
+	if (!m_solved)
+		return -1;
+
+	int best = -1;
+	int ties = 0;
+	for (int cell = 0; cell < m_nCells; cell++)
+	{
+		if (m_counts[cell] == 0)
+			continue;
+		if (best < 0 || m_counts[cell] > m_counts[best])
+		{
+			best = cell;
+			ties = 1;
+		}
+		else if (m_counts[cell] == m_counts[best] && rng.randInt(++ties) == 0)
+			best = cell;
+	}
+
+	return best;
+}
@@ -0,0 +1,83 @@
+
+#ifndef ENDGAMESOLVER_INCLUDED
+#define ENDGAMESOLVER_INCLUDED
+
+#include "globals.h"
+#include "Bitboard.h"
+#include <vector>
+#include <memory>
+#include <cstdint>
+
+class Game;
+class PlacementTable;
+
+// Late in a game few fleets agree with the shots, and an EndgameSolver
+// lists every one of them, giving the exact chance that each cell holds a
+// ship.  Until then it only keeps, for each ship length, the placements
+// that miss every miss, which costs a few steps per miss.  Once the
+// product of the ships' candidate placement counts falls to ENDGAME_LIMIT
+// it enumerates the fleets by depth-first search over those placements.
+// Sunk ships take part too, since a hit next to a sunk ship may belong to
+// it or to a ship still afloat.  From then on each shot only filters the
+// list it already has and takes the fleets it drops out of the counts.
+// A higher limit starts the exact play sooner, saving shots, at the cost
+// of listing more fleets.
+
+const long long ENDGAME_LIMIT = 500;
+
+class EndgameSolver
+{
+public:
+      // The board must fit in a PlacementTable
+    EndgameSolver(const Game& g);
+
+      // Record a valid shot; sunkShip is the id of the ship it sank, or -1
+    void record(int cell, bool shotHit, int sunkShip);
+
+      // Enumerate the fleets if that has become cheap enough, and return
+      // true if the solver has them all
+    bool solve();
+
+    long long nFleets() const { return static_cast<long long>(m_fleetCells.size()); }
+      // The fraction of the fleets that cover the cell
+    double probability(int cell) const;
+
+      // The unfired cell the most fleets cover, ties broken at random, or
+      // -1 if solve has not succeeded
+    int bestCell(Rng& rng) const;
+
+private:
+    void candidates(int shipId, std::vector<int>& live) const;
+    void enumerate(long long bound);
+    void search(int depth, const Bitboard& used);
+    bool agrees(int fleet, int cell, bool shotHit, int sunkShip) const;
+    void count();
+
+    const Game& m_game;
+    std::shared_ptr<const PlacementTable> m_table;
+    int m_nCells;
+    std::vector<bool> m_afloat;
+      // For each length class, the placements that cover no miss, as
+      // bits in the form of PlacementTable::coverBits, and their number
+    std::vector< std::vector<std::uint64_t> > m_clear;
+    std::vector<int> m_clearCount;
+    std::vector<int> m_classShip;   // a ship of each length class
+    std::vector< std::vector<int> > m_sunkPlacements;  // per sunk ship
+    Bitboard m_fired;
+    Bitboard m_hits;
+    bool m_solved;
+
+      // Every fleet, as the cells it covers and the placement of each
+      // ship, in m_ships order
+    std::vector<int> m_ships;
+    std::vector<Bitboard> m_fleetCells;
+    std::vector<std::int16_t> m_fleetPlacements;
+    std::vector<int> m_counts;   // fleets covering each cell
+
+      // The search
+    std::vector< std::vector<int> > m_live;
+    std::vector<int> m_lengthLeft;   // total length of ships depth and on
+    std::vector<int> m_chosen;
+};
+
+#endif // ENDGAMESOLVER_INCLUDED
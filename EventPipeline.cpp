@@ -0,0 +1,256 @@
+#include "EventPipeline.h"
+#include "GameLog.h"
+#include <algorithm>
+#include <chrono>
+#include <cstring>
+
+using namespace std;
+
+//A sink with nothing to do yields this many times before it
+//starts sleeping between looks at its queue
+
+const int EVENT_SPINS = 64;
+const int EVENT_SLEEP_MICROSECONDS = 100;
+
+//*********************************************************************
+//  EventPipeline
+//*********************************************************************
+
+EventPipeline::EventPipeline(size_t capacity)
+ : m_capacity(capacity), m_closing(false)
+{}
+
+EventPipeline::~EventPipeline()
+{
+	m_closing.store(true, memory_order_release);
+	for (size_t k = 0; k < m_lanes.size(); k++)
+		m_lanes[k]->worker.join();
+}
+
+void EventPipeline::addSink(EventSink& sink)
+{
+	m_lanes.push_back(unique_ptr<Lane>(new Lane(sink, m_capacity)));
+	Lane& lane = *m_lanes.back();
+	lane.worker = thread(&EventPipeline::drain, this, ref(lane));
+}
+
+//A full queue means the sink is a whole queue behind, so the
+//game gives way to it until there is room
+
+void EventPipeline::publish(const GameEvent& e)
+{
+	for (size_t k = 0; k < m_lanes.size(); k++)
+		while (!m_lanes[k]->queue.tryPush(e))
+			this_thread::yield();
+}
+
+//Everything published before closing was set is seen once
+//closing is, so the queue is only empty for good after that
+
+void EventPipeline::drain(Lane& lane)
+{
+	GameEvent e;
+	int idle = 0;
+	while (true)
+	{
+		if (lane.queue.tryPop(e))
+		{
+			lane.sink.handle(e);
+			idle = 0;
+		}
+		else if (m_closing.load(memory_order_acquire))
+		{
+			if (!lane.queue.tryPop(e))
+				break;
+			lane.sink.handle(e);
+		}
+		else if (++idle < EVENT_SPINS)
+			this_thread::yield();
+		else
+			this_thread::sleep_for(chrono::microseconds(EVENT_SLEEP_MICROSECONDS));
+	}
+}
+
+static GameEvent makeEvent(GameEvent::Type type, int who)
+{
+	GameEvent e = GameEvent();
+	e.type = type;
+	e.who = who;
+	e.shipId = -1;
+	e.dir = HORIZONTAL;
+	return e;
+}
+
+void EventPipeline::gameStarted(const Player& p1, const Player& p2,
+	const Board& b1, const Board& b2)
+{
+	const Board* boards[2] = { &b1, &b2 };
+	for (int b = 0; b < 2; b++)
+	{
+		for (int s = 0; s < p1.game().nShips(); s++)
+		{
+			GameEvent e = makeEvent(GameEvent::PLACEMENT, b);
+			e.shipId = s;
+			boards[b]->shipPlacement(s, e.p, e.dir);
+			publish(e);
+		}
+	}
+
+	GameEvent e = makeEvent(GameEvent::GAME_STARTED, 0);
+	e.seed = p1.game().seed();
+	const Player* players[2] = { &p1, &p2 };
+	for (int k = 0; k < 2; k++)
+	{
+		e.human[k] = players[k]->isHuman();
+		const string name = players[k]->name();
+		const size_t length = min(name.size(), static_cast<size_t>(EVENT_NAME_BYTES - 1));
+		memcpy(e.name[k], name.data(), length);
+		e.name[k][length] = '\0';
+	}
+	publish(e);
+}
+
+void EventPipeline::attackMade(int turn, const Player& /* attacker */, Point p,
+	bool validShot, bool shotHit, bool shipDestroyed, int shipId,
+	const Board& /* target */)
+{
+	GameEvent e = makeEvent(GameEvent::ATTACK, turn);
+	e.p = p;
+	e.valid = validShot;
+	e.hit = shotHit;
+	e.sunk = shipDestroyed;
+	publish(e);
+
+	if (shipDestroyed)
+	{
+		GameEvent sink = makeEvent(GameEvent::SINK, turn);
+		sink.p = p;
+		sink.shipId = shipId;
+		publish(sink);
+	}
+}
+
+void EventPipeline::gameOver(const GameResult& result, const Player& /* p1 */,
+	const Player& /* p2 */, const Board& /* b1 */, const Board& /* b2 */)
+{
+	GameEvent e = makeEvent(GameEvent::GAME_OVER, result.winnerIndex);
+	e.shots[0] = result.shots[0];
+	e.shots[1] = result.shots[1];
+	publish(e);
+}
+
+//*********************************************************************
+//  ObserverSink
+//*********************************************************************
+
+//Only the size and fleet of g are copied; the sink never
+//touches g again, so g may start its next game at once
+
+ObserverSink::ObserverSink(const Game& g)
+ : m_game(g.rows(), g.cols()), m_observer(nullptr)
+{
+	for (int s = 0; s < g.nShips(); s++)
+		m_game.addShip(g.shipLength(s), g.shipSymbol(s), g.shipName(s));
+}
+
+//Each shot is played on the sink's own boards, so the observer
+//sees them just as they were in the game
+
+void ObserverSink::handle(const GameEvent& e)
+{
+	switch (e.type)
+	{
+	case GameEvent::PLACEMENT:
+		if (m_boards[e.who] == nullptr)
+			m_boards[e.who].reset(new Board(m_game));
+		m_boards[e.who]->placeShip(e.p, e.shipId, e.dir);
+		break;
+
+	case GameEvent::GAME_STARTED:
+		m_game.reseed(e.seed);
+		for (int k = 0; k < 2; k++)
+		{
+			if (m_boards[k] == nullptr)
+				m_boards[k].reset(new Board(m_game));
+			m_players[k].reset(new StandIn(e.name[k], e.human[k], m_game));
+		}
+		if (m_observer != nullptr)
+			m_observer->gameStarted(*m_players[0], *m_players[1], *m_boards[0], *m_boards[1]);
+		break;
+
+	case GameEvent::ATTACK:
+	{
+		Board& target = *m_boards[1 - e.who];
+		if (m_observer != nullptr)
+			m_observer->turnStarted(e.who, *m_players[e.who], *m_players[1 - e.who], target);
+
+		bool shotHit = false;
+		bool destroyed = false;
+		int shipId = -1;
+		const bool validShot = target.attack(e.p, shotHit, destroyed, shipId);
+		if (m_observer != nullptr)
+			m_observer->attackMade(e.who, *m_players[e.who], e.p, validShot,
+				shotHit, destroyed, shipId, target);
+		break;
+	}
+
+	case GameEvent::SINK:
+		break;
+
+	case GameEvent::GAME_OVER:
+	{
+		GameResult result;
+		result.winnerIndex = e.who;
+		if (e.who >= 0)
+			result.winner = m_players[e.who].get();
+		result.shots[0] = e.shots[0];
+		result.shots[1] = e.shots[1];
+		result.turns = e.shots[0];
+		if (m_observer != nullptr)
+			m_observer->gameOver(result, *m_players[0], *m_players[1], *m_boards[0], *m_boards[1]);
+		m_boards[0].reset();
+		m_boards[1].reset();
+		break;
+	}
+	}
+}
+
+ConsoleSink::ConsoleSink(const Game& g)
+ : ObserverSink(g), m_console(createConsoleObserver(game(), false))
+{
+	setObserver(m_console.get());
+}
+
+LogSink::LogSink(GameLog& log, const Game& g)
+ : ObserverSink(g), m_recorder(new GameLogObserver(log, game()))
+{
+	setObserver(m_recorder.get());
+}
+
+//*********************************************************************
+//  StatsSink
+//*********************************************************************
+
+void StatsSink::handle(const GameEvent& e)
+{
+	switch (e.type)
+	{
+	case GameEvent::ATTACK:
+		m_totals.shots[e.who]++;
+		if (e.hit)
+			m_totals.hits[e.who]++;
+		break;
+	case GameEvent::SINK:
+		m_totals.sinks[e.who]++;
+		break;
+	case GameEvent::GAME_OVER:
+		m_totals.games++;
+		if (e.who >= 0)
+			m_totals.wins[e.who]++;
+		else
+			m_totals.undecided++;
+		break;
+	default:
+		break;
+	}
+}
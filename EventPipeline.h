@@ -0,0 +1,196 @@
+
+#ifndef EVENTPIPELINE_INCLUDED
+#define EVENTPIPELINE_INCLUDED
+
+#include "globals.h"
+#include "GameObserver.h"
+#include "SpscQueue.h"
+#include "Game.h"
+#include "Board.h"
+#include "Player.h"
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <thread>
+#include <vector>
+
+class GameLog;
+
+// A GameEvent is one step of a game, copied out of the game so that it can
+// be handled on another thread after the game has moved on.  Turns and
+// boards are numbered 0 for the first player and 1 for the second.
+
+const int EVENT_NAME_BYTES = 32;
+
+struct GameEvent
+{
+    enum Type
+    {
+        PLACEMENT,      // ship shipId of board who is at p, facing dir
+        GAME_STARTED,   // every PLACEMENT of the game has been sent
+        ATTACK,         // who fired at p
+        SINK,           // who sank ship shipId with the ATTACK just sent
+        GAME_OVER       // who won (-1 if no one), after shots[0] and shots[1]
+    };
+
+    Type type;
+    int who;
+    int shipId;
+    Point p;
+    Direction dir;
+    bool valid;
+    bool hit;
+    bool sunk;
+
+      // GAME_STARTED only; names are cut to fit
+    std::uint64_t seed;
+    bool human[2];
+    char name[2][EVENT_NAME_BYTES];
+
+      // GAME_OVER only
+    int shots[2];
+};
+
+// An EventSink handles the events of a pipeline on a thread of its own, in
+// the order they were published.
+
+class EventSink
+{
+public:
+    virtual ~EventSink() {}
+    virtual void handle(const GameEvent& e) = 0;
+};
+
+// An EventPipeline is a GameObserver that turns what it is told into
+// GameEvents and publishes each one to every sink.  Each sink has its own
+// lock-free queue and thread, so the game only pays for copying the event;
+// it waits only if a sink falls a whole queue behind.  One thread plays the
+// games a pipeline watches.  Destroying the pipeline waits until every
+// sink has handled every event.
+
+const std::size_t EVENT_QUEUE_CAPACITY = 1 << 12;
+
+class EventPipeline : public GameObserver
+{
+public:
+    explicit EventPipeline(std::size_t capacity = EVENT_QUEUE_CAPACITY);
+    ~EventPipeline();
+
+      // Add every sink before the first game starts
+    void addSink(EventSink& sink);
+
+    virtual void gameStarted(const Player& p1, const Player& p2,
+                             const Board& b1, const Board& b2);
+    virtual void attackMade(int turn, const Player& attacker, Point p,
+                            bool validShot, bool shotHit, bool shipDestroyed,
+                            int shipId, const Board& target);
+    virtual void gameOver(const GameResult& result, const Player& p1,
+                          const Player& p2, const Board& b1, const Board& b2);
+
+    EventPipeline(const EventPipeline&) = delete;
+    EventPipeline& operator=(const EventPipeline&) = delete;
+
+private:
+    struct Lane
+    {
+        Lane(EventSink& s, std::size_t capacity) : sink(s), queue(capacity) {}
+        EventSink& sink;
+        SpscQueue<GameEvent> queue;
+        std::thread worker;
+    };
+
+    void publish(const GameEvent& e);
+    void drain(Lane& lane);
+
+    std::size_t m_capacity;
+    std::vector< std::unique_ptr<Lane> > m_lanes;
+    std::atomic<bool> m_closing;
+};
+
+// An ObserverSink plays the events on boards of its own and tells an
+// ordinary GameObserver about them, so any observer can watch a game from
+// a sink thread.  The observer must be made for game(), the sink's own
+// copy of the game's board size and fleet.
+
+class ObserverSink : public EventSink
+{
+public:
+    explicit ObserverSink(const Game& g);
+
+    const Game& game() const { return m_game; }
+    void setObserver(GameObserver* observer) { m_observer = observer; }
+
+    virtual void handle(const GameEvent& e);
+
+private:
+      // Stands in for a player, giving its name and whether it is human
+    class StandIn : public Player
+    {
+    public:
+        StandIn(std::string nm, bool human, const Game& g)
+         : Player(nm, g), m_human(human)
+        {}
+        virtual bool isHuman() const { return m_human; }
+        virtual bool placeShips(Board&) { return false; }
+        virtual Point recommendAttack() { return Point(); }
+        virtual void recordAttackResult(Point, bool, bool, bool, int) {}
+        virtual void recordAttackByOpponent(Point) {}
+    private:
+        bool m_human;
+    };
+
+    Game m_game;
+    GameObserver* m_observer;
+    std::unique_ptr<Board> m_boards[2];
+    std::unique_ptr<StandIn> m_players[2];
+};
+
+// Shows each game the way Game::play does, without pausing
+
+class ConsoleSink : public ObserverSink
+{
+public:
+    explicit ConsoleSink(const Game& g);
+private:
+    std::unique_ptr<GameObserver> m_console;
+};
+
+// Records each game in a GameLog
+
+class LogSink : public ObserverSink
+{
+public:
+    LogSink(GameLog& log, const Game& g);
+private:
+    std::unique_ptr<GameObserver> m_recorder;
+};
+
+// Keeps running totals of the games it sees.  Read them once the pipeline
+// has been destroyed.
+
+struct EventTotals
+{
+    EventTotals() : games(0), undecided(0)
+    {
+        for (int k = 0; k < 2; k++)
+            wins[k] = shots[k] = hits[k] = sinks[k] = 0;
+    }
+    long long games;
+    long long undecided;
+    long long wins[2];    // by the player who moved first and second
+    long long shots[2];
+    long long hits[2];
+    long long sinks[2];
+};
+
+class StatsSink : public EventSink
+{
+public:
+    virtual void handle(const GameEvent& e);
+    const EventTotals& totals() const { return m_totals; }
+private:
+    EventTotals m_totals;
+};
+
+#endif // EVENTPIPELINE_INCLUDED
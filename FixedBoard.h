@@ -0,0 +1,308 @@
+
+#ifndef FIXEDBOARD_INCLUDED
+#define FIXEDBOARD_INCLUDED
+
+#include "globals.h"
+#include "Bitboard.h"
+#include <array>
+#include <cstdint>
+
+// A FixedBoard is a board whose size and fleet are template arguments, so
+// that bounds checks, cell masks and the table of every ship placement are
+// worked out by the compiler.  The standard game (10x10, with the ships of
+// StandardFleet) uses FixedBoard<10, 10, StandardFleet>; boards of any
+// other shape and fleet are handled by the runtime-sized boards.
+
+// A Fleet lists the lengths of its ships, in ship id order
+
+template <int... Lengths>
+struct Fleet
+{
+    static constexpr int nShips = sizeof...(Lengths);
+    static constexpr std::array<int, sizeof...(Lengths)> lengths = {{ Lengths... }};
+
+    static constexpr int totalLength()
+    {
+        int total = 0;
+        for (int s = 0; s < nShips; s++)
+            total += lengths[s];
+        return total;
+    }
+};
+
+  // aircraft carrier, battleship, destroyer, submarine, patrol boat
+typedef Fleet<5, 4, 3, 3, 2> StandardFleet;
+
+// A FixedMask is a Bitboard sized exactly for an R x C board
+
+template <int R, int C>
+struct FixedMask
+{
+    static constexpr int WORDS = (R * C + 63) / 64;
+
+    constexpr FixedMask() : w{} {}
+
+    constexpr bool test(int bit) const { return (w[bit >> 6] >> (bit & 63)) & 1; }
+    constexpr void set(int bit) { w[bit >> 6] |= std::uint64_t(1) << (bit & 63); }
+
+    constexpr bool intersects(const FixedMask& other) const
+    {
+        std::uint64_t acc = 0;
+        for (int k = 0; k < WORDS; k++)
+            acc |= w[k] & other.w[k];
+        return acc != 0;
+    }
+    constexpr bool operator==(const FixedMask& other) const
+    {
+        for (int k = 0; k < WORDS; k++)
+            if (w[k] != other.w[k])
+                return false;
+        return true;
+    }
+    constexpr FixedMask& operator|=(const FixedMask& other)
+    {
+        for (int k = 0; k < WORDS; k++)
+            w[k] |= other.w[k];
+        return *this;
+    }
+    constexpr FixedMask& andNot(const FixedMask& other)
+    {
+        for (int k = 0; k < WORDS; k++)
+            w[k] &= ~other.w[k];
+        return *this;
+    }
+    constexpr int count() const
+    {
+        int n = 0;
+        for (int k = 0; k < WORDS; k++)
+            n += popCount(w[k]);
+        return n;
+    }
+
+    std::uint64_t w[WORDS];
+};
+
+// The placements of a fleet on an R x C board, laid out ship by ship.  The
+// placements of ship s are masks[offset[s]] up to masks[offset[s+1]], with
+// the horizontal ones first, as in PlacementTable.
+
+template <int R, int C>
+constexpr int fixedPlacementCount(int length)
+{
+    return (length <= C ? R * (C - length + 1) : 0) +
+           (length <= R ? (R - length + 1) * C : 0);
+}
+
+template <int R, int C, class F>
+constexpr int fixedFleetPlacementCount()
+{
+    int n = 0;
+    for (int s = 0; s < F::nShips; s++)
+        n += fixedPlacementCount<R, C>(F::lengths[s]);
+    return n;
+}
+
+template <int R, int C, class F>
+struct FixedPlacementTable
+{
+    std::array<int, F::nShips + 1> offset;
+    std::array<FixedMask<R, C>, fixedFleetPlacementCount<R, C, F>()> masks;
+};
+
+template <int R, int C, class F>
+constexpr FixedPlacementTable<R, C, F> buildFixedPlacementTable()
+{
+    FixedPlacementTable<R, C, F> table{};
+    int n = 0;
+
+    for (int s = 0; s < F::nShips; s++)
+    {
+        const int length = F::lengths[s];
+        table.offset[s] = n;
+
+        for (int r = 0; r < R; r++)
+            for (int c = 0; c + length <= C; c++, n++)
+                for (int k = 0; k < length; k++)
+                    table.masks[n].set(r * C + c + k);
+
+        for (int r = 0; r + length <= R; r++)
+            for (int c = 0; c < C; c++, n++)
+                for (int k = 0; k < length; k++)
+                    table.masks[n].set((r + k) * C + c);
+    }
+
+    table.offset[F::nShips] = n;
+    return table;
+}
+
+template <int R, int C, class F = StandardFleet>
+class FixedBoard
+{
+public:
+    typedef FixedMask<R, C> Mask;
+
+    static constexpr int ROWS = R;
+    static constexpr int COLS = C;
+    static constexpr int CELLS = R * C;
+    static constexpr int NSHIPS = F::nShips;
+    static constexpr FixedPlacementTable<R, C, F> table =
+        buildFixedPlacementTable<R, C, F>();
+
+    static_assert(F::nShips < 128, "ship ids are stored in a signed char");
+    static_assert(F::totalLength() <= R * C, "the fleet does not fit");
+
+    FixedBoard() { clear(); }
+
+    static constexpr bool isValid(int r, int c)
+    {
+        return r >= 0 && r < R && c >= 0 && c < C;
+    }
+
+      // Index into table.masks of the ship's placement at (r, c), or -1
+    static constexpr int indexOf(int shipId, int r, int c, Direction dir)
+    {
+        const int length = F::lengths[shipId];
+        if (r < 0 || c < 0)
+            return -1;
+        if (dir == HORIZONTAL)
+        {
+            if (r >= R || c + length > C)
+                return -1;
+            return table.offset[shipId] + r * (C - length + 1) + c;
+        }
+        if (r + length > R || c >= C)
+            return -1;
+        const int nHorizontal = length <= C ? R * (C - length + 1) : 0;
+        return table.offset[shipId] + nHorizontal + r * C + c;
+    }
+
+    void clear()
+    {
+        m_occupied = m_blocked = m_shots = m_hits = Mask();
+        for (int k = 0; k < CELLS; k++)
+            m_owner[k] = -1;
+        for (int s = 0; s < NSHIPS; s++)
+        {
+            m_placed[s] = -1;
+            m_afloat[s] = 0;
+        }
+        m_cellsAfloat = 0;
+    }
+
+    void block(const Mask& cells) { m_blocked |= cells; }
+    void unblock() { m_blocked = Mask(); }
+
+    bool placeShip(int r, int c, int shipId, Direction dir)
+    {
+        if (shipId < 0 || shipId >= NSHIPS || m_placed[shipId] >= 0)
+            return false;
+        const int k = indexOf(shipId, r, c, dir);
+        if (k < 0)
+            return false;
+        const Mask& mask = table.masks[k];
+        if (mask.intersects(m_occupied) || mask.intersects(m_blocked) ||
+            mask.intersects(m_shots))
+            return false;
+
+        m_occupied |= mask;
+        for (int j = 0; j < F::lengths[shipId]; j++)
+            m_owner[dir == HORIZONTAL ? r * C + c + j : (r + j) * C + c] =
+                static_cast<signed char>(shipId);
+        m_placed[shipId] = k;
+        m_afloat[shipId] = F::lengths[shipId];
+        m_cellsAfloat += F::lengths[shipId];
+        return true;
+    }
+
+    bool unplaceShip(int r, int c, int shipId, Direction dir)
+    {
+        if (shipId < 0 || shipId >= NSHIPS)
+            return false;
+        const int k = indexOf(shipId, r, c, dir);
+        if (k < 0 || k != m_placed[shipId])
+            return false;
+
+        const Mask& mask = table.masks[k];
+        m_occupied.andNot(mask);
+        m_hits.andNot(mask);
+        for (int j = 0; j < F::lengths[shipId]; j++)
+            m_owner[dir == HORIZONTAL ? r * C + c + j : (r + j) * C + c] = -1;
+        m_cellsAfloat -= m_afloat[shipId];
+        m_afloat[shipId] = 0;
+        m_placed[shipId] = -1;
+        return true;
+    }
+
+    bool attack(int r, int c, bool& shotHit, bool& shipDestroyed, int& shipId)
+    {
+        shotHit = false;
+        shipDestroyed = false;
+        if (!isValid(r, c))
+            return false;
+
+        const int cell = r * C + c;
+        if (m_shots.test(cell) || m_blocked.test(cell))
+            return false;
+        m_shots.set(cell);
+
+        const int owner = m_owner[cell];
+        if (owner < 0)
+            return true;
+
+        shotHit = true;
+        m_hits.set(cell);
+        m_cellsAfloat--;
+        if (--m_afloat[owner] == 0)
+        {
+            shipDestroyed = true;
+            shipId = owner;
+        }
+        return true;
+    }
+
+    bool allShipsDestroyed() const { return m_cellsAfloat == 0; }
+
+      // The position of the ship; false if it is not placed
+    bool placement(int shipId, int& r, int& c, Direction& dir) const
+    {
+        if (shipId < 0 || shipId >= NSHIPS || m_placed[shipId] < 0)
+            return false;
+        const int length = F::lengths[shipId];
+        const int nHorizontal = length <= C ? R * (C - length + 1) : 0;
+        int k = m_placed[shipId] - table.offset[shipId];
+        if (k < nHorizontal)
+        {
+            dir = HORIZONTAL;
+            r = k / (C - length + 1);
+            c = k % (C - length + 1);
+        }
+        else
+        {
+            k -= nHorizontal;
+            dir = VERTICAL;
+            r = k / C;
+            c = k % C;
+        }
+        return true;
+    }
+
+    int owner(int cell) const { return m_owner[cell]; }
+    bool isShot(int cell) const { return m_shots.test(cell); }
+    bool isHit(int cell) const { return m_hits.test(cell); }
+    bool isBlocked(int cell) const { return m_blocked.test(cell); }
+    const Mask& occupied() const { return m_occupied; }
+    const Mask& shots() const { return m_shots; }
+    const Mask& hits() const { return m_hits; }
+
+private:
+    Mask m_occupied;
+    Mask m_blocked;
+    Mask m_shots;
+    Mask m_hits;
+    signed char m_owner[CELLS];
+    int m_placed[NSHIPS];   // index into table.masks, or -1
+    int m_afloat[NSHIPS];   // cells of each ship not yet hit
+    int m_cellsAfloat;
+};
+
+#endif // FIXEDBOARD_INCLUDED
@@ -0,0 +1,127 @@
+#include "FleetSampler.h"
+#include "PlacementTable.h"
+#include "DensityMap.h"
+
+using namespace std;
+
+//Ships of the same length share their live placements, so the
+//list is built once per length.
+
+FleetSampler::FleetSampler(shared_ptr<const PlacementTable> table, const DensityMap& map,
+	const vector<bool>& afloat)
+ : m_table(table), m_live(table->nShips()), m_isLive(table->nShips()),
+	m_openHits(map.openHits()),
+	m_possible(true)
+{
+	vector<int> firstShip(m_table->nLengthClasses(), -1);
+
+	for (int s = 0; s < m_table->nShips(); s++)
+	{
+		if (!afloat[s])
+			continue;
+		m_afloat.push_back(s);
+
+		const int cls = m_table->lengthClass(s);
+		if (firstShip[cls] >= 0)
+		{
+			m_live[s] = m_live[firstShip[cls]];
+			m_isLive[s] = m_isLive[firstShip[cls]];
+			continue;
+		}
+		firstShip[cls] = s;
+
+		m_isLive[s].assign(m_table->count(s), 0);
+		for (int k = 0; k < m_table->count(s); k++)
+		{
+			if (map.isLive(s, k))
+			{
+				m_live[s].push_back(k);
+				m_isLive[s][k] = 1;
+			}
+		}
+		if (m_live[s].empty())
+			m_possible = false;
+	}
+}
+
+bool FleetSampler::sample(Rng& rng, Bitboard& ships) const
+{
+	ships.clear();
+	if (!m_possible)
+		return false;
+
+	//A fleet fits in a Bitboard, so it has at most 256 ships
+
+	const int nAfloat = static_cast<int>(m_afloat.size());
+	int remaining[BITBOARD_WORDS * 64];
+	int nRemaining = nAfloat;
+	for (int j = 0; j < nAfloat; j++)
+		remaining[j] = m_afloat[j];
+
+	//Cover each open hit in turn with a placement through it,
+	//chosen among every remaining ship's placements there
+
+	Bitboard uncovered = m_openHits;
+
+	while (uncovered.any())
+	{
+		int cell = -1;
+		for (int w = 0; cell < 0; w++)
+			if (uncovered.word(w) != 0)
+				cell = w * 64 + lowestBit(uncovered.word(w));
+
+		int chosenSlot = -1;
+		int chosenK = -1;
+		int seen = 0;
+
+		for (int j = 0; j < nRemaining; j++)
+		{
+			const int s = remaining[j];
+			const int* k = m_table->covering(s, cell);
+			const int* end = k + m_table->coveringCount(s, cell);
+			for ( ; k != end; k++)
+			{
+				if (!m_isLive[s][*k] || m_table->mask(s, *k).intersects(ships))
+					continue;
+				seen++;
+				if (rng.randInt(seen) == 0)
+				{
+					chosenSlot = j;
+					chosenK = *k;
+				}
+			}
+		}
+
+		if (chosenSlot < 0)
+			return false;
+
+		const Bitboard& mask = m_table->mask(remaining[chosenSlot], chosenK);
+		ships |= mask;
+		uncovered.andNot(mask);
+		remaining[chosenSlot] = remaining[--nRemaining];
+	}
+
+	//Scatter the rest of the fleet over its live placements
+
+	for (int j = 0; j < nRemaining; j++)
+	{
+		const vector<int>& live = m_live[remaining[j]];
+		bool placed = false;
+
+		for (int t = 0; t < 32 && !placed; t++)
+		{
+			const Bitboard& mask = m_table->mask(remaining[j],
+				live[rng.randInt(static_cast<int>(live.size()))]);
+			if (!mask.intersects(ships))
+			{
+				ships |= mask;
+				placed = true;
+			}
+		}
+
+		if (!placed)
+			return false;
+	}
+
+	return true;
+}
@@ -0,0 +1,46 @@
+
+#ifndef FLEETSAMPLER_INCLUDED
+#define FLEETSAMPLER_INCLUDED
+
+#include "globals.h"
+#include "Bitboard.h"
+#include <vector>
+#include <memory>
+
+class PlacementTable;
+class DensityMap;
+
+// A FleetSampler draws random positions for the whole of the opponent's
+// fleet that agree with the shots fired so far: no ship covers a miss or a
+// cell of a sunk ship, the ships still afloat cover every open hit, and no
+// two ships overlap.  It takes a snapshot of the shots when it is made, and
+// from then on is only read, so several threads may sample from one
+// FleetSampler at once, each with its own Rng.
+//
+// Open hits are covered first, each by a placement drawn from those through
+// it, and the rest of the fleet is then scattered over the live placements,
+// so a draw needs no search; one that runs into a dead end is rejected.
+
+class FleetSampler
+{
+public:
+    FleetSampler(std::shared_ptr<const PlacementTable> table, const DensityMap& map,
+                 const std::vector<bool>& afloat);
+
+      // False if the ships afloat cannot all be placed
+    bool possible() const { return m_possible; }
+
+      // Draw one fleet, setting ships to the cells the ships afloat cover.
+      // Returns false if this draw was rejected.
+    bool sample(Rng& rng, Bitboard& ships) const;
+
+private:
+    std::shared_ptr<const PlacementTable> m_table;
+    std::vector<int> m_afloat;                  // ids of the ships afloat
+    std::vector< std::vector<int> > m_live;     // live placements of each ship
+    std::vector< std::vector<char> > m_isLive;  // the same, by placement
+    Bitboard m_openHits;
+    bool m_possible;
+};
+
+#endif // FLEETSAMPLER_INCLUDED
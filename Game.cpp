@@ -1,9 +1,14 @@
 #include "Game.h"
 #include "Board.h"
 #include "Player.h"
+#include "GameObserver.h"
+#include "EventPipeline.h"
+#include "BoardRenderer.h"
+#include "PlacementTable.h"
 #include "globals.h"
 #include <iostream>
 #include <string>
+#include <vector>
 #include <cstdlib>
 #include <cctype>
 
@@ -17,12 +22,19 @@ class GameImpl
     int cols() const;
     bool isValid(Point p) const;
     Point randomPoint() const;
+    Rng& rng() const;
+    void reseed(uint64_t seed);
+    uint64_t seed() const;
+    StrategyCounters& counters() const;
     bool addShip(int length, char symbol, string name);
     int nShips() const;
+    int totalShipLength() const;
     int shipLength(int shipId) const;
     char shipSymbol(int shipId) const;
     string shipName(int shipId) const;
-    Player* play(Player* p1, Player* p2, Board& b1, Board& b2, bool shouldPause);
+    shared_ptr<const PlacementTable> placementTable() const;
+    Player* play(const Game& g, Player* p1, Player* p2, Board& b1, Board& b2, bool shouldPause);
+    GameResult run(Player* p1, Player* p2, Board& b1, Board& b2, GameObserver* observer);
 private:
 
 	//This struct is used to represent a ship object
@@ -34,11 +46,32 @@ private:
 		string shipName;
 	};
 
-	ship m_ships[100];
+	//Ships are only told apart by their index here. The
+	//symbol is just what the ship looks like on a board.
+
+	vector<ship> m_ships;
 
 	int m_rows;
 	int m_cols;
 	int m_shipNumber;
+	int m_totalLength;
+
+	//Every bit of randomness in a game comes from here
+
+	uint64_t m_seed;
+	mutable Rng m_rng;
+
+	//Counters of the players' work in the current game
+
+	mutable StrategyCounters m_counters;
+
+	//The placement table of the board and fleet, looked up the
+	//first time it is asked for after the fleet last changed,
+	//so players made for each game need not take the lock of
+	//PlacementTable::lookup
+
+	mutable shared_ptr<const PlacementTable> m_table;
+	mutable bool m_tableFound;
 };
 
 void waitForEnter()
@@ -52,6 +85,9 @@ GameImpl::GameImpl(int nRows, int nCols)
 	m_rows = nRows;
 	m_cols = nCols;
 	m_shipNumber = 0;
+	m_totalLength = 0;
+	m_tableFound = false;
+	reseed(Rng::randomSeed());
 }
 
 int GameImpl::rows() const
@@ -71,7 +107,28 @@ bool GameImpl::isValid(Point p) const
 
 Point GameImpl::randomPoint() const
 {
-    return Point(randInt(rows()), randInt(cols()));
+    return Point(m_rng.randInt(rows()), m_rng.randInt(cols()));
+}
+
+Rng& GameImpl::rng() const
+{
+	return m_rng;
+}
+
+void GameImpl::reseed(uint64_t seed)
+{
+	m_seed = seed;
+	m_rng.seed(seed);
+}
+
+uint64_t GameImpl::seed() const
+{
+	return m_seed;
+}
+
+StrategyCounters& GameImpl::counters() const
+{
+	return m_counters;
 }
 
 bool GameImpl::addShip(int length, char symbol, string name)
@@ -81,20 +138,18 @@ bool GameImpl::addShip(int length, char symbol, string name)
 	if (name == "")
 		return false;
 
-	for (int k = 0; k < m_shipNumber; k++)
-	{
-		if (symbol == m_ships[k].shipSymbol)
-			return false;
-	}
+	ship newShip;
+	newShip.shipLength = length;
+	newShip.shipSymbol = symbol;
+	newShip.shipName = name;
 
-	const int type = m_shipNumber;
+	m_ships.push_back(newShip);
 	m_shipNumber++;
+	m_totalLength += length;
+	m_table = nullptr;
+	m_tableFound = false;
 
-	m_ships[type].shipLength = length;
-	m_ships[type].shipSymbol = symbol;
-	m_ships[type].shipName = name;
-
-    return true;  // This compiles but may not be correct
+    return true;
 }
 
 int GameImpl::nShips() const
@@ -102,6 +157,11 @@ int GameImpl::nShips() const
 	return m_shipNumber;
 }
 
+int GameImpl::totalShipLength() const
+{
+	return m_totalLength;
+}
+
 int GameImpl::shipLength(int shipId) const  //needs check
 {
 	int length = m_ships[shipId].shipLength;
@@ -123,129 +183,194 @@ string GameImpl::shipName(int shipId) const  //needs check
 	return name;
 }
 
-Player* GameImpl::play(Player* p1, Player* p2, Board& b1, Board& b2, bool shouldPause)  //needs to fix press enter to continue issue
+shared_ptr<const PlacementTable> GameImpl::placementTable() const
 {
+	if (!m_tableFound)
+	{
+		vector<int> lengths;
+		for (size_t s = 0; s < m_ships.size(); s++)
+			lengths.push_back(m_ships[s].shipLength);
+		m_table = PlacementTable::lookup(m_rows, m_cols, lengths);
+		m_tableFound = true;
+	}
+	return m_table;
+}
 
-	if (!p1->placeShips(b1) || !p2->placeShips(b2))
-		return nullptr;
+//The game loop itself does no I/O at all. Everything that
+//wants to show or record the game is told about it through
+//the observer, if there is one.
 
-	bool shotsHitOne = false;
-	bool shotsHitTwo = false;
-	bool destroyedOne = false;
-	bool destroyedTwo = false;
-	int idOne = -1;
-	int idTwo = -1;
+GameResult GameImpl::run(Player* p1, Player* p2, Board& b1, Board& b2, GameObserver* observer)
+{
+	GameResult result;
+	m_counters.clear();
 
-	while (!b1.allShipsDestroyed() && !b2.allShipsDestroyed())
+	if (!p1->placeShips(b1) || !p2->placeShips(b2))
 	{
+		result.counters = m_counters;
+		return result;
+	}
 
-	///////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
-	//                                           Player 1's turn:
-	///////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
-		
-		cout << p1->name() << "'s turn. Board for " << p2->name() << endl;
-
-		b2.display(p1->isHuman());
+	Player* players[2] = { p1, p2 };
+	Board* targets[2] = { &b2, &b1 };
 
-		Point p = p1->recommendAttack();
+	if (observer != nullptr)
+		observer->gameStarted(*p1, *p2, b1, b2);
 
-		if (!b2.attack(p, shotsHitOne, destroyedOne, idOne))
+	if (!b1.allShipsDestroyed() && !b2.allShipsDestroyed())
+	{
+		for (int turn = 0; ; turn = 1 - turn)
 		{
-			cout << p1->name() << " wasted a shot at (" << p.r << "," << p.c << ")" << endl;
-			p1->recordAttackResult(p, false, false, false, -1);
-		}
+			Player* attacker = players[turn];
+			Player* defender = players[1 - turn];
+			Board& target = *targets[turn];
 
-		else
-		{
-			p1->recordAttackResult(p, true, shotsHitOne, destroyedOne, idOne);
+			if (turn == 0)
+				result.turns++;
 
-			cout << p1->name() << " attacked (" << p.r << "," << p.c << ")" << " and ";
+			if (observer != nullptr)
+				observer->turnStarted(turn, *attacker, *defender, target);
 
-			if (shotsHitOne)
-			{
-				if (!destroyedOne)
-					cout << "hit something, resulting in:" << endl;
+			Point p = attacker->recommendAttack();
+			result.shots[turn]++;
 
-				else
-					cout << "destroyed the " << shipName(idOne) << ", resulting in:" << endl;
-			}
-			else
-				cout << "missed, resulting in:" << endl;
+			bool shotHit = false;
+			bool destroyed = false;
+			int shipId = -1;
 
-			b2.display(p1->isHuman());
-		}
+			const bool validShot = target.attack(p, shotHit, destroyed, shipId);
 
-		if (shouldPause)
-			waitForEnter();
+			if (validShot)
+				attacker->recordAttackResult(p, true, shotHit, destroyed, shipId);
+			else
+				attacker->recordAttackResult(p, false, false, false, -1);
+			defender->recordAttackByOpponent(p);
 
-		//Check if this player beats the opponent
+			if (observer != nullptr)
+				observer->attackMade(turn, *attacker, p, validShot, shotHit,
+					destroyed, shipId, target);
 
-		if (b2.allShipsDestroyed())
-			break;
+			//Check if this player beats the opponent
 
+			if (shotHit && target.allShipsDestroyed())
+			{
+				result.winnerIndex = turn;
+				break;
+			}
+		}
+	}
 
-	///////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
-	//                                           Player 2's turn:
-	///////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
-		
-		cout << p2->name() << "'s turn. Board for " << p1->name() << endl;
+	else
+		result.winnerIndex = b1.allShipsDestroyed() ? 1 : 0;
 
-		b1.display(p2->isHuman());
+	result.winner = players[result.winnerIndex];
+	result.counters = m_counters;
 
-		Point b = p2->recommendAttack();
+	if (observer != nullptr)
+		observer->gameOver(result, *p1, *p2, b1, b2);
 
-		if (b1.attack(b, shotsHitTwo, destroyedTwo, idTwo))
-		{
-			p2->recordAttackResult(b, true, shotsHitTwo, destroyedTwo, idTwo);
+	return result;
+}
 
-			cout << p2->name() << " attacked (" << b.r << "," << b.c << ")" << " and ";
+//This observer prints the game to cout, optionally
+//waiting for the user between turns. Each board goes out
+//with the line above it in a single write.
 
-			if (shotsHitTwo)
-			{
-				if (!destroyedTwo)
-					cout << "hit something, resulting in:" << endl;
-				else
-					cout << "destroyed " << shipName(idTwo) << ", resulting in:" << endl;
-			}
-			else
-				cout << "missed, resulting in:" << endl;
+class ConsoleObserver : public GameObserver
+{
+public:
+	ConsoleObserver(const Game& g, bool shouldPause)
+		: m_game(g), m_shouldPause(shouldPause),
+		m_renderer(BoardRenderer::defaultMode())
+	{}
+
+	virtual void turnStarted(int turn, const Player& attacker,
+		const Player& defender, const Board& target);
+	virtual void attackMade(int turn, const Player& attacker, Point p,
+		bool validShot, bool shotHit, bool shipDestroyed, int shipId,
+		const Board& target);
+	virtual void gameOver(const GameResult& result, const Player& p1,
+		const Player& p2, const Board& b1, const Board& b2);
 
-			b1.display(p2->isHuman());
-		}
+private:
+	const Game& m_game;
+	bool m_shouldPause;
+	BoardRenderer m_renderer;
+};
 
-		else
-		{
-			p2->recordAttackResult(b, false, false, false, -1);
+void ConsoleObserver::turnStarted(int /* turn */, const Player& attacker,
+	const Player& defender, const Board& target)
+{
+	m_renderer.draw(m_game, target, attacker.isHuman(),
+		attacker.name() + "'s turn. Board for " + defender.name());
+}
 
-			cout << p2->name() << " wasted a shot at (" << b.r << "," << b.c << ")" << endl;
-		}
+void ConsoleObserver::attackMade(int turn, const Player& attacker, Point p,
+	bool validShot, bool shotHit, bool shipDestroyed, int shipId,
+	const Board& target)
+{
+	if (!validShot)
+		cout << attacker.name() << " wasted a shot at (" << p.r << "," << p.c << ")" << '\n';
 
-		if (shouldPause)
+	else
+	{
+		string caption = attacker.name() + " attacked (" + to_string(p.r) + "," +
+			to_string(p.c) + ")" + " and ";
+
+		if (shotHit)
 		{
-			if (p2->isHuman())
-				cin.ignore(100000000000, '\n');
-			waitForEnter();
+			if (!shipDestroyed)
+				caption += "hit something, resulting in:";
+			else
+				caption += "destroyed the " + m_game.shipName(shipId) + ", resulting in:";
 		}
-	}
+		else
+			caption += "missed, resulting in:";
 
-	//Now that the game has over...
+		m_renderer.draw(m_game, target, attacker.isHuman(), caption);
+	}
 
-	if (b1.allShipsDestroyed())
+	if (m_shouldPause)
 	{
-		if (p1->isHuman())
-			b2.display(false);
-		return p2;
+		if (turn == 1 && attacker.isHuman())
+			cin.ignore(100000000000, '\n');
+		waitForEnter();
 	}
+}
+
+//Once the game is over, a human who lost gets to see
+//where the opponent's ships were.
+
+void ConsoleObserver::gameOver(const GameResult& result, const Player& p1,
+	const Player& p2, const Board& b1, const Board& b2)
+{
+	if (result.winnerIndex == 1 && p1.isHuman())
+		m_renderer.draw(m_game, b2, false);
+	else if (result.winnerIndex == 0 && p2.isHuman())
+		m_renderer.draw(m_game, b1, false);
+}
+
+GameObserver* createConsoleObserver(const Game& g, bool shouldPause)
+{
+	return new ConsoleObserver(g, shouldPause);
+}
+
+//When no one is waiting on the display, it is printed by a
+//sink thread so the players never wait on cout. A pause or
+//a human player needs the display in step with the game.
 
-	if (b2.allShipsDestroyed())
+Player* GameImpl::play(const Game& g, Player* p1, Player* p2, Board& b1, Board& b2, bool shouldPause)
+{
+	if (shouldPause || p1->isHuman() || p2->isHuman())
 	{
-		if (p2->isHuman())
-			b1.display(false);
-		return p1;
+		ConsoleObserver console(g, shouldPause);
+		return run(p1, p2, b1, b2, &console).winner;
 	}
 
-
-    return nullptr;  // This compiles but may not be correct
+	ConsoleSink console(g);
+	EventPipeline pipeline;
+	pipeline.addSink(console);
+	return run(p1, p2, b1, b2, &pipeline).winner;
 }
 
 //******************** Game functions *******************************
@@ -293,6 +418,26 @@ Point Game::randomPoint() const
     return m_impl->randomPoint();
 }
 
+Rng& Game::rng() const
+{
+    return m_impl->rng();
+}
+
+void Game::reseed(uint64_t seed)
+{
+    m_impl->reseed(seed);
+}
+
+uint64_t Game::seed() const
+{
+    return m_impl->seed();
+}
+
+StrategyCounters& Game::counters() const
+{
+    return m_impl->counters();
+}
+
 bool Game::addShip(int length, char symbol, string name)
 {
     if (length < 1)
@@ -318,18 +463,8 @@ bool Game::addShip(int length, char symbol, string name)
              << endl;
         return false;
     }
-    int totalOfLengths = 0;
-    for (int s = 0; s < nShips(); s++)
-    {
-        totalOfLengths += shipLength(s);
-        if (shipSymbol(s) == symbol)
-        {
-            cout << "Ship symbol " << symbol
-                 << " must not be used for more than one ship" << endl;
-            return false;
-        }
-    }
-    if (totalOfLengths + length > rows() * cols())
+      // Ships are identified by id, so several may share a symbol
+    if (m_impl->totalShipLength() + length > rows() * cols())
     {
         cout << "Board is too small to fit all ships" << endl;
         return false;
@@ -360,12 +495,27 @@ string Game::shipName(int shipId) const
     return m_impl->shipName(shipId);
 }
 
+shared_ptr<const PlacementTable> Game::placementTable() const
+{
+    return m_impl->placementTable();
+}
+
 Player* Game::play(Player* p1, Player* p2, bool shouldPause)
 {
     if (p1 == nullptr  ||  p2 == nullptr  ||  nShips() == 0)
         return nullptr;
     Board b1(*this);
     Board b2(*this);
-    return m_impl->play(p1, p2, b1, b2, shouldPause);
+    return m_impl->play(*this, p1, p2, b1, b2, shouldPause);
 }
 
+
+
+GameResult Game::run(Player* p1, Player* p2, GameObserver* observer)
+{
+    if (p1 == nullptr  ||  p2 == nullptr  ||  nShips() == 0)
+        return GameResult();
+    Board b1(*this);
+    Board b2(*this);
+    return m_impl->run(p1, p2, b1, b2, observer);
+}
\ No newline at end of file
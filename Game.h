@@ -4,10 +4,31 @@
 
 #include <string>
 #include <cassert>
+#include <cstdint>
+#include <memory>
+#include "Counters.h"
 
 class Point;
+class Rng;
 class Player;
 class GameImpl;
+class GameObserver;
+class PlacementTable;
+
+// The outcome of a game played by Game::run
+
+struct GameResult
+{
+    GameResult() : winner(nullptr), winnerIndex(-1), turns(0)
+    {
+        shots[0] = shots[1] = 0;
+    }
+    Player* winner;   // nullptr if the game could not be played
+    int winnerIndex;  // 0 if the first player won, 1 if the second, else -1
+    int shots[2];     // shots fired by the first and the second player
+    int turns;        // rounds started; a round is one shot by each player
+    StrategyCounters counters;  // work done by both players in this game
+};
 
 class Game
 {
@@ -18,12 +39,18 @@ public:
     int cols() const;
     bool isValid(Point p) const;
     Point randomPoint() const;
+    Rng& rng() const;
+    void reseed(std::uint64_t seed);
+    std::uint64_t seed() const;
+    StrategyCounters& counters() const;
     bool addShip(int length, char symbol, std::string name);
     int nShips() const;
     int shipLength(int shipId) const;
     char shipSymbol(int shipId) const;
     std::string shipName(int shipId) const;
+    std::shared_ptr<const PlacementTable> placementTable() const;
     Player* play(Player* p1, Player* p2, bool shouldPause = true);
+    GameResult run(Player* p1, Player* p2, GameObserver* observer = nullptr);
     Game(const Game&) = delete;
     Game& operator=(const Game&) = delete;
     
@@ -0,0 +1,344 @@
+#include "GameLog.h"
+#include "Game.h"
+#include "Board.h"
+#include <algorithm>
+
+using namespace std;
+
+const char GAME_LOG_MAGIC[GAME_LOG_MAGIC_BYTES] = { 'B', 'S', 'L', 'O', 'G', '1', '\n', 0 };
+
+//A buffer is handed to the writer once it holds this much, and
+//appending waits while this many full buffers are still queued
+
+const size_t GAME_LOG_BUFFER_BYTES = 1 << 16;
+const size_t GAME_LOG_MAX_QUEUED = 8;
+
+//No game comes near this; a longer record means a damaged log
+
+const uint64_t GAME_LOG_MAX_RECORD = 1 << 26;
+
+//*********************************************************************
+//  Varints
+//*********************************************************************
+
+static void putVarint(vector<uint8_t>& out, uint64_t v)
+{
+	while (v >= 0x80)
+	{
+		out.push_back(static_cast<uint8_t>(v | 0x80));
+		v >>= 7;
+	}
+	out.push_back(static_cast<uint8_t>(v));
+}
+
+static uint64_t zigzag(long long v)
+{
+	return (static_cast<uint64_t>(v) << 1) ^ static_cast<uint64_t>(v >> 63);
+}
+
+static long long unzigzag(uint64_t v)
+{
+	return static_cast<long long>(v >> 1) ^ -static_cast<long long>(v & 1);
+}
+
+//Reads from a record, remembering whether it ever ran off the end
+
+class RecordReader
+{
+public:
+	RecordReader(const vector<uint8_t>& bytes) : m_bytes(bytes), m_at(0), m_ok(true) {}
+
+	uint64_t varint()
+	{
+		uint64_t v = 0;
+		for (int shift = 0; shift < 64; shift += 7)
+		{
+			if (m_at >= m_bytes.size())
+				break;
+			const uint8_t b = m_bytes[m_at++];
+			v |= static_cast<uint64_t>(b & 0x7f) << shift;
+			if ((b & 0x80) == 0)
+				return v;
+		}
+		m_ok = false;
+		return 0;
+	}
+
+	uint8_t byte()
+	{
+		if (m_at >= m_bytes.size())
+		{
+			m_ok = false;
+			return 0;
+		}
+		return m_bytes[m_at++];
+	}
+
+	bool ok() const { return m_ok; }
+
+private:
+	const vector<uint8_t>& m_bytes;
+	size_t m_at;
+	bool m_ok;
+};
+
+//*********************************************************************
+//  GameLog
+//*********************************************************************
+
+GameLog::GameLog(const string& path)
+ : m_file(fopen(path.c_str(), "wb")), m_closing(false)
+{
+	if (m_file == nullptr)
+		return;
+	fwrite(GAME_LOG_MAGIC, 1, GAME_LOG_MAGIC_BYTES, m_file);
+	m_filling.reserve(GAME_LOG_BUFFER_BYTES);
+	m_writer = thread(&GameLog::writeBuffers, this);
+}
+
+GameLog::~GameLog()
+{
+	if (m_file == nullptr)
+		return;
+
+	{
+		lock_guard<mutex> lock(m_lock);
+		if (!m_filling.empty())
+			m_full.push_back(move(m_filling));
+		m_closing = true;
+	}
+	m_ready.notify_one();
+	m_writer.join();
+	fclose(m_file);
+}
+
+void GameLog::append(const vector<uint8_t>& record)
+{
+	if (m_file == nullptr)
+		return;
+
+	vector<uint8_t> length;
+	putVarint(length, record.size());
+
+	unique_lock<mutex> lock(m_lock);
+	m_filling.insert(m_filling.end(), length.begin(), length.end());
+	m_filling.insert(m_filling.end(), record.begin(), record.end());
+	if (m_filling.size() < GAME_LOG_BUFFER_BYTES)
+		return;
+
+	m_drained.wait(lock, [this] { return m_full.size() < GAME_LOG_MAX_QUEUED; });
+	m_full.push_back(move(m_filling));
+	m_filling = vector<uint8_t>();
+	m_filling.reserve(GAME_LOG_BUFFER_BYTES);
+	lock.unlock();
+	m_ready.notify_one();
+}
+
+//The writer takes every full buffer at once and writes them
+//without holding the lock
+
+void GameLog::writeBuffers()
+{
+	deque< vector<uint8_t> > taken;
+
+	while (true)
+	{
+		bool closing;
+		{
+			unique_lock<mutex> lock(m_lock);
+			m_ready.wait(lock, [this] { return !m_full.empty() || m_closing; });
+			taken.swap(m_full);
+			closing = m_closing;
+		}
+		m_drained.notify_all();
+
+		for (size_t k = 0; k < taken.size(); k++)
+			fwrite(taken[k].data(), 1, taken[k].size(), m_file);
+		taken.clear();
+
+		if (closing)
+		{
+			lock_guard<mutex> lock(m_lock);
+			if (m_full.empty())
+				break;
+		}
+	}
+
+	fflush(m_file);
+}
+
+//*********************************************************************
+//  GameLogObserver
+//*********************************************************************
+
+GameLogObserver::GameLogObserver(GameLog& log, const Game& g, long long gameNumber)
+ : m_log(log), m_game(g), m_gameNumber(gameNumber)
+{}
+
+void GameLogObserver::gameStarted(const Player& /* p1 */, const Player& /* p2 */,
+	const Board& b1, const Board& b2)
+{
+	m_record.clear();
+	putVarint(m_record, m_gameNumber);
+	putVarint(m_record, m_game.seed());
+	putVarint(m_record, m_game.rows());
+	putVarint(m_record, m_game.cols());
+	putVarint(m_record, m_game.nShips());
+
+	for (int s = 0; s < m_game.nShips(); s++)
+	{
+		const string name = m_game.shipName(s);
+		putVarint(m_record, m_game.shipLength(s));
+		m_record.push_back(static_cast<uint8_t>(m_game.shipSymbol(s)));
+		putVarint(m_record, name.size());
+		m_record.insert(m_record.end(), name.begin(), name.end());
+	}
+
+	const Board* boards[2] = { &b1, &b2 };
+	for (int b = 0; b < 2; b++)
+	{
+		for (int s = 0; s < m_game.nShips(); s++)
+		{
+			Point p;
+			Direction dir = HORIZONTAL;
+			boards[b]->shipPlacement(s, p, dir);
+			putVarint(m_record, (static_cast<uint64_t>(p.r) * m_game.cols() + p.c) * 2 +
+				(dir == VERTICAL ? 1 : 0));
+		}
+	}
+}
+
+void GameLogObserver::attackMade(int /* turn */, const Player& /* attacker */,
+	Point p, bool validShot, bool shotHit, bool shipDestroyed, int shipId,
+	const Board& /* target */)
+{
+	if (!validShot)
+	{
+		putVarint(m_record, 2);
+		putVarint(m_record, zigzag(p.r));
+		putVarint(m_record, zigzag(p.c));
+		return;
+	}
+
+	const uint64_t cell = static_cast<uint64_t>(p.r) * m_game.cols() + p.c;
+	putVarint(m_record, (cell + 1) * 8 + 1 + (shotHit ? 2 : 0) + (shipDestroyed ? 4 : 0));
+	if (shipDestroyed)
+		putVarint(m_record, shipId);
+}
+
+void GameLogObserver::gameOver(const GameResult& result, const Player& /* p1 */,
+	const Player& /* p2 */, const Board& /* b1 */, const Board& /* b2 */)
+{
+	putVarint(m_record, 0);
+	putVarint(m_record, result.winnerIndex + 1);
+	m_log.append(m_record);
+	m_record.clear();
+}
+
+//*********************************************************************
+//  GameLogReader
+//*********************************************************************
+
+GameLogReader::GameLogReader(istream& in)
+ : m_in(in), m_ok(false), m_atEnd(false)
+{
+	char magic[GAME_LOG_MAGIC_BYTES];
+	if (m_in.read(magic, GAME_LOG_MAGIC_BYTES))
+		m_ok = equal(magic, magic + GAME_LOG_MAGIC_BYTES, GAME_LOG_MAGIC);
+}
+
+bool GameLogReader::next(LoggedGame& game)
+{
+	if (!m_ok)
+		return false;
+
+	//The length of the record comes first
+
+	uint64_t length = 0;
+	int shift = 0;
+	int c;
+	do
+	{
+		c = m_in.get();
+		if (c == EOF && shift == 0)
+			m_atEnd = true;
+		if (c == EOF || shift >= 64)
+			return false;
+		length |= static_cast<uint64_t>(c & 0x7f) << shift;
+		shift += 7;
+	} while (c & 0x80);
+
+	if (length > GAME_LOG_MAX_RECORD)
+		return false;
+	m_record.resize(length);
+	if (length > 0 && !m_in.read(reinterpret_cast<char*>(m_record.data()), length))
+		return false;
+
+	RecordReader in(m_record);
+	game.gameNumber = static_cast<long long>(in.varint());
+	game.seed = in.varint();
+	game.rows = static_cast<int>(in.varint());
+	game.cols = static_cast<int>(in.varint());
+	const uint64_t nShips = in.varint();
+	if (!in.ok() || nShips > length)
+		return false;
+
+	game.ships.resize(nShips);
+	for (size_t s = 0; s < nShips; s++)
+	{
+		game.ships[s].length = static_cast<int>(in.varint());
+		game.ships[s].symbol = static_cast<char>(in.byte());
+		const uint64_t nameLength = in.varint();
+		if (!in.ok() || nameLength > length)
+			return false;
+		game.ships[s].name.clear();
+		for (uint64_t k = 0; k < nameLength; k++)
+			game.ships[s].name += static_cast<char>(in.byte());
+	}
+
+	for (int b = 0; b < 2; b++)
+	{
+		game.placements[b].resize(nShips);
+		for (size_t s = 0; s < nShips; s++)
+		{
+			const uint64_t v = in.varint();
+			const long long cell = static_cast<long long>(v / 2);
+			game.placements[b][s].topOrLeft = Point(
+				static_cast<int>(cell / max(game.cols, 1)), static_cast<int>(cell % max(game.cols, 1)));
+			game.placements[b][s].dir = (v % 2 == 1 ? VERTICAL : HORIZONTAL);
+		}
+	}
+
+	game.shots.clear();
+	while (in.ok())
+	{
+		const uint64_t v = in.varint();
+		if (v == 0)
+			break;
+
+		LoggedShot shot;
+		shot.shipId = -1;
+		if (v == 2)
+		{
+			shot.valid = shot.hit = shot.sank = false;
+			const int r = static_cast<int>(unzigzag(in.varint()));
+			const int c = static_cast<int>(unzigzag(in.varint()));
+			shot.p = Point(r, c);
+		}
+		else
+		{
+			const long long cell = static_cast<long long>(v / 8) - 1;
+			shot.valid = true;
+			shot.hit = (v & 2) != 0;
+			shot.sank = (v & 4) != 0;
+			shot.p = Point(static_cast<int>(cell / max(game.cols, 1)),
+				static_cast<int>(cell % max(game.cols, 1)));
+			if (shot.sank)
+				shot.shipId = static_cast<int>(in.varint());
+		}
+		game.shots.push_back(shot);
+	}
+
+	game.winnerIndex = static_cast<int>(in.varint()) - 1;
+	return in.ok();
+}
@@ -0,0 +1,151 @@
+
+#ifndef GAMELOG_INCLUDED
+#define GAMELOG_INCLUDED
+
+#include "globals.h"
+#include "GameObserver.h"
+#include <cstdint>
+#include <cstdio>
+#include <deque>
+#include <istream>
+#include <mutex>
+#include <condition_variable>
+#include <string>
+#include <thread>
+#include <vector>
+
+class Game;
+
+// A game log is a compact binary record of whole games.  The file starts
+// with the 8 bytes "BSLOG1\n" and a 0, followed by one record per game,
+// each prefixed with its length in bytes.  Every number is a varint: 7
+// bits per byte, low bits first, with the high bit set on all bytes but
+// the last.  A record holds
+//
+//     the game number (0 if not from a match) and the seed
+//     rows, cols and the number of ships; for each ship its length, its
+//         symbol (one byte) and its name (a length and the bytes)
+//     the placement of each ship of the first player's board, then of the
+//         second player's, each as (r * cols + c) * 2 + dir
+//     one number per shot, the players taking turns starting with the
+//         first: a valid shot at cell is (cell + 1) * 8 + 1, plus 2 if it
+//         hit and 4 if it sank a ship, whose id follows; an invalid shot
+//         is 2 followed by its row and column, zigzag coded
+//     0 to end the shots, then the index of the winner plus 1
+
+const int GAME_LOG_MAGIC_BYTES = 8;
+extern const char GAME_LOG_MAGIC[GAME_LOG_MAGIC_BYTES];
+
+// A GameLog appends game records to a file.  Records are gathered into
+// large buffers that a background thread writes out, so the games playing
+// never wait on the disk unless the writer falls several buffers behind.
+// Any number of threads may append at once; each record is written whole.
+
+class GameLog
+{
+public:
+    explicit GameLog(const std::string& path);
+      // Writes out everything appended so far
+    ~GameLog();
+
+    bool ok() const { return m_file != nullptr; }
+    void append(const std::vector<std::uint8_t>& record);
+
+    GameLog(const GameLog&) = delete;
+    GameLog& operator=(const GameLog&) = delete;
+
+private:
+    void writeBuffers();
+
+    std::FILE* m_file;
+    std::mutex m_lock;
+    std::condition_variable m_ready;     // a buffer is full, or closing
+    std::condition_variable m_drained;   // the writer took some buffers
+    std::vector<std::uint8_t> m_filling;
+    std::deque< std::vector<std::uint8_t> > m_full;
+    bool m_closing;
+    std::thread m_writer;
+};
+
+// A GameLogObserver encodes one game as it is played and hands the record
+// to a GameLog when the game is over.
+
+class GameLogObserver : public GameObserver
+{
+public:
+    GameLogObserver(GameLog& log, const Game& g, long long gameNumber = 0);
+
+    virtual void gameStarted(const Player& p1, const Player& p2,
+                             const Board& b1, const Board& b2);
+    virtual void attackMade(int turn, const Player& attacker, Point p,
+                            bool validShot, bool shotHit, bool shipDestroyed,
+                            int shipId, const Board& target);
+    virtual void gameOver(const GameResult& result, const Player& p1,
+                          const Player& p2, const Board& b1, const Board& b2);
+
+private:
+    GameLog& m_log;
+    const Game& m_game;
+    long long m_gameNumber;
+    std::vector<std::uint8_t> m_record;
+};
+
+// A game decoded from a log
+
+struct LoggedShot
+{
+    Point p;
+    bool valid;
+    bool hit;
+    bool sank;
+    int shipId;       // of the ship sunk, or -1
+};
+
+struct LoggedGame
+{
+    struct Ship
+    {
+        int length;
+        char symbol;
+        std::string name;
+    };
+    struct Placement
+    {
+        Point topOrLeft;
+        Direction dir;
+    };
+
+    long long gameNumber;
+    std::uint64_t seed;
+    int rows;
+    int cols;
+    std::vector<Ship> ships;
+    std::vector<Placement> placements[2];
+    std::vector<LoggedShot> shots;   // alternately by the first and second player
+    int winnerIndex;                 // -1 if no one won
+};
+
+// A GameLogReader decodes the games of a log one at a time, so a log of
+// any length can be read in constant memory.
+
+class GameLogReader
+{
+public:
+    explicit GameLogReader(std::istream& in);
+
+      // False if the stream does not start like a game log
+    bool ok() const { return m_ok; }
+      // Decode the next game; false at the end of the log or if the record
+      // is damaged
+    bool next(LoggedGame& game);
+      // True once next has found the log ended cleanly after a record
+    bool atEnd() const { return m_atEnd; }
+
+private:
+    std::istream& m_in;
+    bool m_ok;
+    bool m_atEnd;
+    std::vector<std::uint8_t> m_record;
+};
+
+#endif // GAMELOG_INCLUDED
@@ -0,0 +1,49 @@
+
+#ifndef GAMEOBSERVER_INCLUDED
+#define GAMEOBSERVER_INCLUDED
+
+#include "globals.h"
+
+class Board;
+class Player;
+class Game;
+struct GameResult;
+
+// A GameObserver is told about each step of a game run by Game::run.  The
+// game itself does no I/O; anything that wants to show or record a game
+// (the console display, for one) is an observer.  Turns are numbered 0 for
+// the first player and 1 for the second.
+
+class GameObserver
+{
+public:
+    virtual ~GameObserver() {}
+
+      // Both players have placed their ships; b1 and b2 are the boards of
+      // p1 and p2
+    virtual void gameStarted(const Player& /* p1 */, const Player& /* p2 */,
+                             const Board& /* b1 */, const Board& /* b2 */) {}
+
+      // attacker is about to fire at target, which belongs to defender
+    virtual void turnStarted(int /* turn */, const Player& /* attacker */,
+                             const Player& /* defender */,
+                             const Board& /* target */) {}
+
+      // attacker fired at p; the arguments are those of Board::attack
+    virtual void attackMade(int /* turn */, const Player& /* attacker */,
+                            Point /* p */, bool /* validShot */,
+                            bool /* shotHit */, bool /* shipDestroyed */,
+                            int /* shipId */, const Board& /* target */) {}
+
+      // b1 and b2 are the boards of p1 and p2
+    virtual void gameOver(const GameResult& /* result */,
+                          const Player& /* p1 */, const Player& /* p2 */,
+                          const Board& /* b1 */, const Board& /* b2 */) {}
+};
+
+// The observer Game::play shows a game with, printing to cout and, if
+// shouldPause, waiting for the user after each shot.  The caller deletes it.
+
+GameObserver* createConsoleObserver(const Game& g, bool shouldPause);
+
+#endif // GAMEOBSERVER_INCLUDED
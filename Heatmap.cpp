@@ -0,0 +1,350 @@
+#include "Heatmap.h"
+#include "PlacementTable.h"
+
+#if (defined(__GNUC__) || defined(__clang__)) && \
+    (defined(__x86_64__) || defined(__i386__)) && !defined(BATTLESHIP_NO_AVX2)
+#define HEATMAP_AVX2
+#include <immintrin.h>
+#endif
+
+using namespace std;
+
+//A run of masks to be counted, each the given number of times.
+//A kernel returns the number of masks that cover no miss, each
+//counted once however many times its run is.
+
+struct MaskRun
+{
+	const Bitboard* masks;
+	int nMasks;
+	int times;
+};
+
+typedef int (*HeatmapKernel)(const MaskRun*, int, const Bitboard&,
+	const Bitboard&, int, int[], int);
+
+static int scalarHeatmap(const MaskRun* runs, int nRuns, const Bitboard& misses,
+	const Bitboard& hits, int hitWeight, int counts[], int /* nCells */)
+{
+	int legal = 0;
+
+	for (int r = 0; r < nRuns; r++)
+	{
+		const Bitboard* masks = runs[r].masks;
+
+		for (int k = 0; k < runs[r].nMasks; k++)
+		{
+			if (masks[k].intersects(misses))
+				continue;
+			legal++;
+
+			const int add = runs[r].times * (masks[k].intersects(hits) ? hitWeight : 1);
+			forEachCell(masks[k], [&](int cell) { counts[cell] += add; });
+		}
+	}
+
+	return legal;
+}
+
+#ifdef HEATMAP_AVX2
+
+static_assert(BITBOARD_WORDS == 4, "a Bitboard must fill one AVX2 register");
+
+//The masks are summed into bit-sliced counters: plane b holds
+//bit b of the count of every cell. Groups of eight masks first
+//go through a tree of carry-save adders into the ones, twos and
+//fours planes, so only one mask in eight carries any further.
+
+const int PLANES = 16;
+const int MASKS_PER_FLUSH = (1 << PLANES) - 8;
+
+struct SlicedCounts
+{
+	__m256i plane[PLANES];
+	int used;   // planes that may be nonzero
+};
+
+__attribute__((target("avx2")))
+static inline __m256i load(const Bitboard& b)
+{
+	return _mm256_loadu_si256(reinterpret_cast<const __m256i*>(b.words()));
+}
+
+  // All ones if x has no bit set, else all zeros
+__attribute__((target("avx2")))
+static inline __m256i isEmpty(__m256i x)
+{
+	x = _mm256_or_si256(x, _mm256_permute4x64_epi64(x, 0x4E));
+	x = _mm256_or_si256(x, _mm256_shuffle_epi32(x, 0x4E));
+	return _mm256_cmpeq_epi64(x, _mm256_setzero_si256());
+}
+
+  // a + b + c, as a sum bit and a carry bit for each cell
+__attribute__((target("avx2")))
+static inline void carrySave(__m256i& carry, __m256i& sum, __m256i a, __m256i b, __m256i c)
+{
+	const __m256i u = _mm256_xor_si256(a, b);
+	carry = _mm256_or_si256(_mm256_and_si256(a, b), _mm256_and_si256(u, c));
+	sum = _mm256_xor_si256(u, c);
+}
+
+__attribute__((target("avx2")))
+static inline void addEight(SlicedCounts& counts, const __m256i m[8])
+{
+	__m256i* p = counts.plane;
+	__m256i ones = p[0], twos = p[1], fours = p[2];
+	__m256i twosA, twosB, foursA, foursB, eights;
+
+	carrySave(twosA, ones, ones, m[0], m[1]);
+	carrySave(twosB, ones, ones, m[2], m[3]);
+	carrySave(foursA, twos, twos, twosA, twosB);
+	carrySave(twosA, ones, ones, m[4], m[5]);
+	carrySave(twosB, ones, ones, m[6], m[7]);
+	carrySave(foursB, twos, twos, twosA, twosB);
+	carrySave(eights, fours, fours, foursA, foursB);
+	p[0] = ones;
+	p[1] = twos;
+	p[2] = fours;
+
+	for (int b = 3; !_mm256_testz_si256(eights, eights); b++)
+	{
+		const __m256i next = _mm256_and_si256(p[b], eights);
+		p[b] = _mm256_xor_si256(p[b], eights);
+		eights = next;
+		if (b >= counts.used)
+			counts.used = b + 1;
+	}
+}
+
+//Turn the planes into counts 32 cells at a time: each 32-bit
+//piece of a plane is spread into one byte per cell, and the
+//planes are folded in from the top, doubling as they go. Byte
+//counts hold 8 planes, so more are done 8 at a time.
+
+__attribute__((target("avx2")))
+static void flush(SlicedCounts& sliced, int weight, int counts[], int nCells)
+{
+	alignas(32) uint32_t words[PLANES][8];
+	for (int b = 0; b < sliced.used; b++)
+		_mm256_store_si256(reinterpret_cast<__m256i*>(words[b]), sliced.plane[b]);
+
+	const __m256i spread = _mm256_setr_epi8(
+		0, 0, 0, 0, 0, 0, 0, 0, 1, 1, 1, 1, 1, 1, 1, 1,
+		2, 2, 2, 2, 2, 2, 2, 2, 3, 3, 3, 3, 3, 3, 3, 3);
+	const __m256i bit = _mm256_set1_epi64x(static_cast<long long>(0x8040201008040201ULL));
+	const __m256i one = _mm256_set1_epi8(1);
+
+	for (int g = 0; g * 32 < nCells; g++)
+	{
+		for (int low = 0; low < sliced.used; low += 8)
+		{
+			const int high = sliced.used < low + 8 ? sliced.used : low + 8;
+			__m256i bytes = _mm256_setzero_si256();
+			for (int b = high - 1; b >= low; b--)
+			{
+				const __m256i x = _mm256_shuffle_epi8(
+					_mm256_set1_epi32(static_cast<int>(words[b][g])), spread);
+				bytes = _mm256_add_epi8(_mm256_add_epi8(bytes, bytes),
+					_mm256_min_epu8(_mm256_and_si256(x, bit), one));
+			}
+
+			const __m256i scale = _mm256_set1_epi32(weight << low);
+			const __m128i halves[2] = {
+				_mm256_castsi256_si128(bytes), _mm256_extracti128_si256(bytes, 1)
+			};
+
+			for (int q = 0; q < 4 && g * 32 + q * 8 < nCells; q++)
+			{
+				const __m128i part = q % 2 == 0 ? halves[q / 2] :
+					_mm_srli_si128(halves[q / 2], 8);
+				const __m256i add = _mm256_mullo_epi32(scale, _mm256_cvtepu8_epi32(part));
+				int* out = counts + g * 32 + q * 8;
+
+				if (g * 32 + q * 8 + 8 <= nCells)
+					_mm256_storeu_si256(reinterpret_cast<__m256i*>(out), _mm256_add_epi32(
+						_mm256_loadu_si256(reinterpret_cast<const __m256i*>(out)), add));
+				else
+				{
+					alignas(32) int last[8];
+					_mm256_store_si256(reinterpret_cast<__m256i*>(last), add);
+					for (int c = 0; g * 32 + q * 8 + c < nCells; c++)
+						out[c] += last[c];
+				}
+			}
+		}
+	}
+
+	for (int b = 0; b < sliced.used; b++)
+		sliced.plane[b] = _mm256_setzero_si256();
+	sliced.used = 3;
+}
+
+__attribute__((target("avx2")))
+static bool isZero(const SlicedCounts& sliced)
+{
+	__m256i any = _mm256_setzero_si256();
+	for (int b = 0; b < sliced.used; b++)
+		any = _mm256_or_si256(any, sliced.plane[b]);
+	return _mm256_testz_si256(any, any);
+}
+
+//A mask that covers a miss is zeroed rather than skipped, so
+//the loop has no branches on the data. Masks that also cover a
+//hit go into a second set of counts, weighted by the extra
+//hitWeight - 1 they are worth; with no hits, that set is left
+//out altogether. Legal masks are counted on a run's first pass
+//only, as the scalar loop counts them.
+
+template <bool WITH_HITS>
+__attribute__((target("avx2")))
+static int avx2Sum(const MaskRun* runs, int nRuns, const Bitboard& misses,
+	const Bitboard& hits, int hitWeight, int counts[], int nCells)
+{
+	const __m256i miss = load(misses);
+	const __m256i hit = load(hits);
+
+	SlicedCounts all, onHit;
+	for (int b = 0; b < PLANES; b++)
+		all.plane[b] = onHit.plane[b] = _mm256_setzero_si256();
+	all.used = onHit.used = 3;
+
+	__m256i legal = _mm256_setzero_si256();
+	__m256i m[8], h[8];
+	int n = 0;
+	int sinceFlush = 0;
+
+	for (int r = 0; r < nRuns; r++)
+	{
+		for (int t = 0; t < runs[r].times; t++)
+		{
+			const Bitboard* masks = runs[r].masks;
+			for (int k = 0; k < runs[r].nMasks; k++)
+			{
+				const __m256i x = load(masks[k]);
+				const __m256i ok = isEmpty(_mm256_and_si256(x, miss));
+				if (t == 0)
+					legal = _mm256_sub_epi64(legal, ok);
+				m[n] = _mm256_and_si256(x, ok);
+				if (WITH_HITS)
+					h[n] = _mm256_andnot_si256(isEmpty(_mm256_and_si256(x, hit)), m[n]);
+
+				if (++n < 8)
+					continue;
+				addEight(all, m);
+				if (WITH_HITS)
+					addEight(onHit, h);
+				n = 0;
+
+				sinceFlush += 8;
+				if (sinceFlush == MASKS_PER_FLUSH)
+				{
+					flush(all, 1, counts, nCells);
+					if (WITH_HITS)
+						flush(onHit, hitWeight - 1, counts, nCells);
+					sinceFlush = 0;
+				}
+			}
+		}
+	}
+
+	if (n > 0)
+	{
+		for ( ; n < 8; n++)
+			m[n] = h[n] = _mm256_setzero_si256();
+		addEight(all, m);
+		if (WITH_HITS)
+			addEight(onHit, h);
+	}
+
+	flush(all, 1, counts, nCells);
+	if (WITH_HITS && !isZero(onHit))
+		flush(onHit, hitWeight - 1, counts, nCells);
+
+	return static_cast<int>(_mm256_extract_epi64(legal, 0));
+}
+
+__attribute__((target("avx2")))
+static int avx2Heatmap(const MaskRun* runs, int nRuns, const Bitboard& misses,
+	const Bitboard& hits, int hitWeight, int counts[], int nCells)
+{
+	if (hits.none() || hitWeight == 1)
+		return avx2Sum<false>(runs, nRuns, misses, hits, hitWeight, counts, nCells);
+	return avx2Sum<true>(runs, nRuns, misses, hits, hitWeight, counts, nCells);
+}
+
+#endif // HEATMAP_AVX2
+
+static HeatmapKernel chooseKernel()
+{
+#ifdef HEATMAP_AVX2
+	if (__builtin_cpu_supports("avx2"))
+		return avx2Heatmap;
+#endif
+	return scalarHeatmap;
+}
+
+static HeatmapKernel kernel()
+{
+	static const HeatmapKernel chosen = chooseKernel();
+	return chosen;
+}
+
+int addHeatmap(const Bitboard* masks, int nMasks, const Bitboard& misses,
+	const Bitboard& hits, int hitWeight, int counts[], int nCells)
+{
+	MaskRun run = { masks, nMasks, 1 };
+	return kernel()(&run, 1, misses, hits, hitWeight, counts, nCells);
+}
+
+int addHeatmapScalar(const Bitboard* masks, int nMasks, const Bitboard& misses,
+	const Bitboard& hits, int hitWeight, int counts[], int nCells)
+{
+	MaskRun run = { masks, nMasks, 1 };
+	return scalarHeatmap(&run, 1, misses, hits, hitWeight, counts, nCells);
+}
+
+const char* heatmapKernel()
+{
+	return kernel() == scalarHeatmap ? "scalar" : "avx2";
+}
+
+//Ships of the same length share their masks, so each length
+//is one run of masks, counted once per ship of it afloat, and
+//every run goes through the kernel in a single call.
+
+static void buildShipHeatmap(HeatmapKernel sum, const PlacementTable& table,
+	const vector<bool>& afloat, const Bitboard& misses, const Bitboard& hits,
+	int hitWeight, int counts[])
+{
+	const int nCells = table.rows() * table.cols();
+	for (int cell = 0; cell < nCells; cell++)
+		counts[cell] = 0;
+
+	vector<MaskRun> runs(table.nLengthClasses());
+	for (int cls = 0; cls < table.nLengthClasses(); cls++)
+		runs[cls].times = 0;
+
+	for (int s = 0; s < table.nShips(); s++)
+	{
+		MaskRun& run = runs[table.lengthClass(s)];
+		run.masks = table.masks(s);
+		run.nMasks = table.count(s);
+		if (afloat[s])
+			run.times++;
+	}
+
+	sum(runs.data(), static_cast<int>(runs.size()), misses, hits,
+		hitWeight, counts, nCells);
+}
+
+void shipHeatmap(const PlacementTable& table, const vector<bool>& afloat,
+	const Bitboard& misses, const Bitboard& hits, int hitWeight, int counts[])
+{
+	buildShipHeatmap(kernel(), table, afloat, misses, hits, hitWeight, counts);
+}
+
+void shipHeatmapScalar(const PlacementTable& table, const vector<bool>& afloat,
+	const Bitboard& misses, const Bitboard& hits, int hitWeight, int counts[])
+{
+	buildShipHeatmap(scalarHeatmap, table, afloat, misses, hits, hitWeight, counts);
+}
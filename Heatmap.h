@@ -0,0 +1,44 @@
+
+#ifndef HEATMAP_INCLUDED
+#define HEATMAP_INCLUDED
+
+#include "Bitboard.h"
+#include <vector>
+
+class PlacementTable;
+
+// A heatmap counts, for every cell, the ship placements that cover it and
+// are still possible given the shots fired so far.  These functions build
+// one from scratch from a list of placement masks, for strategies that do
+// not keep their counts up to date shot by shot the way DensityMap does.
+//
+// Where the processor supports AVX2, the masks are summed 256 cells at a
+// time into bit-sliced counters; otherwise a scalar loop does the same work.
+// The choice is made once, at run time.
+
+  // For each mask that covers no cell of misses, add 1 to the count of
+  // every cell it covers, or hitWeight (at least 1) if it also covers a
+  // cell of hits.
+  // The masks must lie within the first nCells cells, which counts holds.
+  // Returns the number of masks that cover no miss.
+int addHeatmap(const Bitboard* masks, int nMasks, const Bitboard& misses,
+               const Bitboard& hits, int hitWeight, int counts[], int nCells);
+
+  // Fill counts, of rows * cols cells, with the heatmap of the ships of the
+  // table that are still afloat.  Cells of sunk ships belong in misses.
+void shipHeatmap(const PlacementTable& table, const std::vector<bool>& afloat,
+                 const Bitboard& misses, const Bitboard& hits, int hitWeight,
+                 int counts[]);
+
+  // "avx2" or "scalar", whichever addHeatmap uses
+const char* heatmapKernel();
+
+  // The same as addHeatmap and shipHeatmap, always with the scalar loop,
+  // so that the AVX2 kernel can be checked against it
+int addHeatmapScalar(const Bitboard* masks, int nMasks, const Bitboard& misses,
+                     const Bitboard& hits, int hitWeight, int counts[], int nCells);
+void shipHeatmapScalar(const PlacementTable& table, const std::vector<bool>& afloat,
+                       const Bitboard& misses, const Bitboard& hits, int hitWeight,
+                       int counts[]);
+
+#endif // HEATMAP_INCLUDED
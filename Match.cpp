@@ -0,0 +1,285 @@
+#include "Match.h"
+#include "Game.h"
+#include "Player.h"
+#include "GameLog.h"
+#include "GameObserver.h"
+#include "globals.h"
+#include <thread>
+#include <atomic>
+#include <vector>
+#include <algorithm>
+#include <cmath>
+
+using namespace std;
+
+void MatchResult::merge(const MatchResult& other)
+{
+	ok = ok && other.ok;
+	for (int k = 0; k < 2; k++)
+		shots[k] += other.shots[k];
+	counters.merge(other.counters);
+	stats.merge(other.stats);
+}
+
+uint64_t gameSeed(uint64_t matchSeed, long long k)
+{
+	uint64_t x = matchSeed ^ static_cast<uint64_t>(k);
+	return Rng::splitMix(x);
+}
+
+//Notes the shot on which each ship was sunk, and passes
+//everything on to the log's observer, if there is one
+
+class SummaryObserver : public GameObserver
+{
+public:
+	SummaryObserver(GameSummary& summary, GameObserver* next)
+	 : m_summary(summary), m_next(next)
+	{}
+
+	virtual void gameStarted(const Player& p1, const Player& p2,
+		const Board& b1, const Board& b2)
+	{
+		const int nShips = p1.game().nShips();
+		m_summary.sunkAt[0].assign(nShips, 0);
+		m_summary.sunkAt[1].assign(nShips, 0);
+		m_fired[0] = m_fired[1] = 0;
+		if (m_next != nullptr)
+			m_next->gameStarted(p1, p2, b1, b2);
+	}
+
+	virtual void attackMade(int turn, const Player& attacker, Point p,
+		bool validShot, bool shotHit, bool shipDestroyed, int shipId,
+		const Board& target)
+	{
+		m_fired[turn]++;
+		if (shipDestroyed)
+		{
+			const int player = (turn == 0 ? m_summary.firstMover : 1 - m_summary.firstMover);
+			m_summary.sunkAt[player][shipId] = m_fired[turn];
+		}
+		if (m_next != nullptr)
+			m_next->attackMade(turn, attacker, p, validShot, shotHit,
+				shipDestroyed, shipId, target);
+	}
+
+	virtual void gameOver(const GameResult& result, const Player& p1,
+		const Player& p2, const Board& b1, const Board& b2)
+	{
+		if (m_next != nullptr)
+			m_next->gameOver(result, p1, p2, b1, b2);
+	}
+
+private:
+	GameSummary& m_summary;
+	GameObserver* m_next;
+	int m_fired[2];
+};
+
+//Games are handed out to the workers in chunks through a
+//single atomic counter, and each worker keeps its own tally
+//on its own stack, so the workers never wait on each other.
+
+const long long GAMES_PER_CHUNK = 64;
+
+static void playGames(const MatchConfig& config, uint64_t seed, long long lastGame,
+	atomic<long long>& nextGame, MatchResult& result)
+{
+	MatchResult tally;
+	GameSummary summary;
+
+	Game g(config.rows, config.cols);
+	if (config.addShips != nullptr && !config.addShips(g))
+		return;
+	if (g.nShips() == 0)
+		return;
+
+	while (true)
+	{
+		const long long first = nextGame.fetch_add(GAMES_PER_CHUNK);
+		if (first > lastGame)
+			break;
+		const long long last = first + GAMES_PER_CHUNK - 1 < lastGame ?
+			first + GAMES_PER_CHUNK - 1 : lastGame;
+
+		for (long long k = first; k <= last; k++)
+		{
+			g.reseed(gameSeed(seed, k));
+
+			Player* p[2];
+			for (int s = 0; s < 2; s++)
+				p[s] = createPlayer(config.type[s], config.name[s], g);
+
+			//Player 0 moves first in odd-numbered games
+
+			const int firstMover = (k % 2 == 1 ? 0 : 1);
+			summary.firstMover = firstMover;
+			summary.sunkAt[0].clear();
+			summary.sunkAt[1].clear();
+			GameResult r;
+			if (config.log != nullptr)
+			{
+				GameLogObserver recorder(*config.log, g, k);
+				SummaryObserver observer(summary, &recorder);
+				r = g.run(p[firstMover], p[1 - firstMover], &observer);
+			}
+			else
+			{
+				SummaryObserver observer(summary, nullptr);
+				r = g.run(p[firstMover], p[1 - firstMover], &observer);
+			}
+
+			tally.shots[firstMover] += r.shots[0];
+			tally.shots[1 - firstMover] += r.shots[1];
+			tally.counters.record(r.counters, k);
+
+			summary.winner = (r.winnerIndex < 0 ? -1 :
+				r.winnerIndex == 0 ? firstMover : 1 - firstMover);
+			summary.shots[firstMover] = r.shots[0];
+			summary.shots[1 - firstMover] = r.shots[1];
+			tally.stats.record(summary);
+
+			delete p[0];
+			delete p[1];
+		}
+	}
+
+	result = tally;
+}
+
+static int threadsToUse(int nThreads)
+{
+	if (nThreads <= 0)
+		nThreads = static_cast<int>(thread::hardware_concurrency());
+	return nThreads > 0 ? nThreads : 1;
+}
+
+//Play games firstGame through lastGame of the match
+
+static MatchResult playRange(const MatchConfig& config, uint64_t seed,
+	long long firstGame, long long lastGame, int nThreads)
+{
+	atomic<long long> nextGame(firstGame);
+	vector<MatchResult> tallies(nThreads);
+	vector<thread> workers;
+
+	for (int t = 1; t < nThreads; t++)
+		workers.push_back(thread(playGames, cref(config), seed, lastGame,
+			ref(nextGame), ref(tallies[t])));
+	playGames(config, seed, lastGame, nextGame, tallies[0]);
+
+	MatchResult result;
+	result.seed = seed;
+	for (int t = 0; t < nThreads; t++)
+	{
+		if (t > 0)
+			workers[t - 1].join();
+		result.merge(tallies[t]);
+	}
+
+	return result;
+}
+
+//The fleet is set up once before any worker starts, so a bad
+//fleet is reported to the caller rather than leaving every
+//worker to give up on its own
+
+static bool fleetWorks(const MatchConfig& config)
+{
+	Game g(config.rows, config.cols);
+	if (config.addShips != nullptr && !config.addShips(g))
+		return false;
+	return g.nShips() > 0;
+}
+
+MatchResult runMatch(const MatchConfig& config, long long nGames, int nThreads)
+{
+	const uint64_t seed = (config.seed != 0 ? config.seed : Rng::randomSeed());
+	if (!fleetWorks(config))
+	{
+		MatchResult result;
+		result.ok = false;
+		result.seed = seed;
+		return result;
+	}
+	return playRange(config, seed, 1, nGames, threadsToUse(nThreads));
+}
+
+//Two one-sided tests run side by side. Test t asks whether
+//player t wins a fraction 1/2 + delta of the games rather than
+//1/2; with W and L its player's wins and losses, its log
+//likelihood ratio is
+//
+//    W ln(1 + 2 delta) + L ln(1 - 2 delta)
+//
+//Each test gets half of alpha, and Wald's bounds ln((1 - beta) /
+//(alpha / 2)) and ln(beta / (1 - alpha / 2)) keep its chances of
+//a wrong verdict near those. A test that falls to the lower
+//bound has found its player no better, and stops.
+//
+//Outside the ranges in Match.h the steps or bounds are infinite,
+//NaN or of the wrong sign, and no test would ever end, so the
+//parameters are pulled into range first.
+
+const double SEQUENTIAL_MIN_DELTA = 0.001;
+const double SEQUENTIAL_MAX_DELTA = 0.49;
+const double SEQUENTIAL_MIN_ERROR = 1e-9;
+const double SEQUENTIAL_MAX_ERROR = 0.5;
+
+static double clampTo(double x, double low, double high)
+{
+	if (!(x >= low))    // NaN too
+		return low;
+	return x > high ? high : x;
+}
+
+SequentialResult runSequentialMatch(const MatchConfig& config,
+	const SequentialTest& test, int nThreads)
+{
+	const double delta = clampTo(test.delta, SEQUENTIAL_MIN_DELTA, SEQUENTIAL_MAX_DELTA);
+	const double alpha = clampTo(test.alpha, SEQUENTIAL_MIN_ERROR, SEQUENTIAL_MAX_ERROR);
+	const double beta = clampTo(test.beta, SEQUENTIAL_MIN_ERROR, SEQUENTIAL_MAX_ERROR);
+
+	SequentialResult result;
+	result.upper = log((1 - beta) / (alpha / 2));
+	result.lower = log(beta / (1 - alpha / 2));
+	const double winStep = log(1 + 2 * delta);
+	const double lossStep = log(1 - 2 * delta);
+
+	const uint64_t seed = (config.seed != 0 ? config.seed : Rng::randomSeed());
+	const long long batch = (test.batch > 0 ? test.batch : 1);
+	nThreads = threadsToUse(nThreads);
+	result.match.seed = seed;
+	if (!fleetWorks(config))
+	{
+		result.match.ok = false;
+		return result;
+	}
+
+	bool noBetter[2] = { false, false };
+	const MatchStats& stats = result.match.stats;
+	while (stats.games < test.maxGames)
+	{
+		const long long first = stats.games + 1;
+		const long long last = min(first + batch - 1, test.maxGames);
+		result.match.merge(playRange(config, seed, first, last, nThreads));
+		result.batches++;
+
+		for (int t = 0; t < 2; t++)
+		{
+			if (noBetter[t])
+				continue;
+			result.llr[t] = stats.wins[t] * winStep + stats.wins[1 - t] * lossStep;
+			if (result.llr[t] >= result.upper)
+				result.better = t;
+			else if (result.llr[t] <= result.lower)
+				noBetter[t] = true;
+		}
+
+		result.even = (noBetter[0] && noBetter[1]);
+		if (result.better >= 0 || result.even)
+			break;
+	}
+
+	return result;
+}
@@ -0,0 +1,102 @@
+
+#ifndef MATCH_INCLUDED
+#define MATCH_INCLUDED
+
+#include <string>
+#include <cstdint>
+#include "Counters.h"
+#include "MatchStats.h"
+
+class Game;
+class GameLog;
+
+// A Match plays many games between two kinds of player (as named to
+// createPlayer) on a fixed board and fleet, spreading the games over a
+// pool of worker threads.  As in a hand-written loop over k = 1..nGames,
+// player 0 moves first in the odd-numbered games and player 1 in the even.
+// Game k is seeded from the match seed and k alone, so any game of a match
+// can be replayed no matter which thread happened to play it.
+
+struct MatchConfig
+{
+    MatchConfig() : rows(10), cols(10), addShips(nullptr), seed(0), log(nullptr) {}
+    int rows;
+    int cols;
+    bool (*addShips)(Game& g);  // adds the fleet to each game's Game
+    std::string type[2];        // player types, as given to createPlayer
+    std::string name[2];
+    std::uint64_t seed;         // 0 means pick a random seed
+    GameLog* log;               // if not nullptr, every game is recorded here
+};
+
+// The games played, won and left undecided are counted in stats alone.
+
+struct MatchResult
+{
+    MatchResult() : ok(true), seed(0)
+    {
+        shots[0] = shots[1] = 0;
+    }
+    void merge(const MatchResult& other);
+
+    bool ok;                    // false if the fleet could not be set up, in
+                                // which case no game was played
+    std::uint64_t seed;         // the match seed that was used
+    long long shots[2];         // shots fired by each player, in all games
+    CounterStats counters;      // all 0 unless built with BATTLESHIP_COUNTERS
+    MatchStats stats;           // counts, distributions and confidence intervals
+};
+
+  // Play nGames games of the match.  nThreads <= 0 means use one thread per
+  // hardware core.
+MatchResult runMatch(const MatchConfig& config, long long nGames, int nThreads = 0);
+
+// A sequential match plays games in batches and, after each batch, runs
+// two of Wald's sequential probability ratio tests on the games won so
+// far, one for each player: that the player wins a fraction 1/2 + delta
+// of the games against that it wins only half.  It stops as soon as one
+// player is found better, or both are found no better than the other,
+// so a lopsided match is settled in a batch or two; otherwise it stops
+// once maxGames have been played.  Games are numbered and seeded as in
+// runMatch, and the tests only look at whole batches, so the verdict does
+// not depend on the threads.  An even batch keeps the first move shared
+// evenly.
+
+// delta is clamped to [0.001, 0.49] and alpha and beta to [1e-9, 0.5];
+// outside those the tests could never reach a verdict.
+
+struct SequentialTest
+{
+    SequentialTest()
+     : delta(0.05), alpha(0.05), beta(0.05), batch(100), maxGames(100000)
+    {}
+    double delta;
+    double alpha;       // chance of finding either player better when they are even
+    double beta;        // chance of missing that a player is better by delta
+    long long batch;
+    long long maxGames;
+};
+
+struct SequentialResult
+{
+    SequentialResult() : better(-1), even(false), lower(0), upper(0), batches(0)
+    {
+        llr[0] = llr[1] = 0;
+    }
+    MatchResult match;  // every game played
+    int better;         // the player found to be better, or -1 if neither
+    bool even;          // neither player was found better by delta
+    double llr[2];      // the log likelihood ratio of each test at the end
+    double lower;       // a test finds its player no better at or below this
+    double upper;       // and better at or above this
+    long long batches;
+};
+
+SequentialResult runSequentialMatch(const MatchConfig& config,
+                                    const SequentialTest& test,
+                                    int nThreads = 0);
+
+  // The seed game k of a match with the given seed is played with
+std::uint64_t gameSeed(std::uint64_t matchSeed, long long k);
+
+#endif // MATCH_INCLUDED
@@ -0,0 +1,181 @@
+#include "MatchStats.h"
+#include <cmath>
+#include <algorithm>
+
+using namespace std;
+
+//*********************************************************************
+//  RunningStat
+//*********************************************************************
+
+void RunningStat::add(double x)
+{
+	n++;
+	if (n == 1)
+		min = max = x;
+	else
+	{
+		min = std::min(min, x);
+		max = std::max(max, x);
+	}
+	const double delta = x - mean;
+	mean += delta / n;
+	m2 += delta * (x - mean);
+}
+
+//Chan's rule for combining two sets of moments
+
+void RunningStat::merge(const RunningStat& other)
+{
+	if (other.n == 0)
+		return;
+	if (n == 0)
+	{
+		*this = other;
+		return;
+	}
+
+	const long long total = n + other.n;
+	const double delta = other.mean - mean;
+	mean += delta * other.n / total;
+	m2 += other.m2 + delta * delta * (static_cast<double>(n) * other.n / total);
+	min = std::min(min, other.min);
+	max = std::max(max, other.max);
+	n = total;
+}
+
+double RunningStat::variance() const
+{
+	return n < 2 ? 0 : m2 / (n - 1);
+}
+
+double RunningStat::stddev() const
+{
+	return sqrt(variance());
+}
+
+double RunningStat::stderror() const
+{
+	return n < 1 ? 0 : sqrt(variance() / n);
+}
+
+//*********************************************************************
+//  Histogram
+//*********************************************************************
+
+void Histogram::add(int v)
+{
+	if (v < 0)
+		v = 0;
+	if (static_cast<size_t>(v) >= counts.size())
+		counts.resize(v + 1, 0);
+	counts[v]++;
+	n++;
+}
+
+void Histogram::merge(const Histogram& other)
+{
+	if (other.counts.size() > counts.size())
+		counts.resize(other.counts.size(), 0);
+	for (size_t v = 0; v < other.counts.size(); v++)
+		counts[v] += other.counts[v];
+	n += other.n;
+}
+
+int Histogram::quantile(double q) const
+{
+	const double wanted = q * n;
+	long long seen = 0;
+	for (size_t v = 0; v < counts.size(); v++)
+	{
+		seen += counts[v];
+		if (seen > 0 && seen >= wanted)
+			return static_cast<int>(v);
+	}
+	return counts.empty() ? 0 : static_cast<int>(counts.size()) - 1;
+}
+
+//*********************************************************************
+//  Intervals
+//*********************************************************************
+
+Interval wilsonInterval(long long successes, long long trials, double z)
+{
+	if (trials <= 0)
+		return Interval();
+
+	const double p = static_cast<double>(successes) / trials;
+	const double z2n = z * z / trials;
+	const double center = (p + z2n / 2) / (1 + z2n);
+	const double half = z * sqrt(p * (1 - p) / trials + z2n / (4 * trials)) / (1 + z2n);
+	return Interval(max(0.0, center - half), min(1.0, center + half));
+}
+
+Interval normalInterval(long long successes, long long trials, double z)
+{
+	if (trials <= 0)
+		return Interval();
+
+	const double p = static_cast<double>(successes) / trials;
+	const double half = z * sqrt(p * (1 - p) / trials);
+	return Interval(max(0.0, p - half), min(1.0, p + half));
+}
+
+//*********************************************************************
+//  MatchStats
+//*********************************************************************
+
+void MatchStats::record(const GameSummary& game)
+{
+	games++;
+	if (game.winner < 0)
+	{
+		undecided++;
+		return;
+	}
+
+	wins[game.winner]++;
+	if (game.winner == game.firstMover)
+		firstMoverWins++;
+	shotsToWin[game.winner].add(game.shots[game.winner]);
+	shotsToWinCounts[game.winner].add(game.shots[game.winner]);
+	shotsPerGame.add(game.shots[0] + game.shots[1]);
+
+	for (int p = 0; p < 2; p++)
+	{
+		const vector<int>& sunkAt = game.sunkAt[p];
+		if (timeToSink[p].size() < sunkAt.size())
+			timeToSink[p].resize(sunkAt.size());
+		for (size_t s = 0; s < sunkAt.size(); s++)
+			if (sunkAt[s] > 0)
+				timeToSink[p][s].add(sunkAt[s]);
+	}
+}
+
+void MatchStats::merge(const MatchStats& other)
+{
+	games += other.games;
+	undecided += other.undecided;
+	firstMoverWins += other.firstMoverWins;
+	shotsPerGame.merge(other.shotsPerGame);
+	for (int p = 0; p < 2; p++)
+	{
+		wins[p] += other.wins[p];
+		shotsToWin[p].merge(other.shotsToWin[p]);
+		shotsToWinCounts[p].merge(other.shotsToWinCounts[p]);
+		if (timeToSink[p].size() < other.timeToSink[p].size())
+			timeToSink[p].resize(other.timeToSink[p].size());
+		for (size_t s = 0; s < other.timeToSink[p].size(); s++)
+			timeToSink[p][s].merge(other.timeToSink[p][s]);
+	}
+}
+
+Interval MatchStats::winRate(int player, double z) const
+{
+	return wilsonInterval(wins[player], decided(), z);
+}
+
+Interval MatchStats::firstMoverRate(double z) const
+{
+	return wilsonInterval(firstMoverWins, decided(), z);
+}
@@ -0,0 +1,100 @@
+
+#ifndef MATCHSTATS_INCLUDED
+#define MATCHSTATS_INCLUDED
+
+#include <vector>
+
+// Statistics of a match that are kept up to date game by game, so a match
+// of any length needs no more memory than its longest game.  Each worker
+// of a match keeps its own and they are merged at the end; merging gives
+// the same counts as recording every game in one place, and the same
+// means and variances up to rounding.
+
+// The count, mean and variance of a stream of numbers, by Welford's method
+
+struct RunningStat
+{
+    RunningStat() : n(0), mean(0), m2(0), min(0), max(0) {}
+    void add(double x);
+    void merge(const RunningStat& other);
+    double variance() const;        // of the sample; 0 for fewer than two
+    double stddev() const;
+    double stderror() const;        // of the mean
+
+    long long n;
+    double mean;
+    double m2;                      // sum of squared differences from the mean
+    double min;
+    double max;
+};
+
+// How many times each whole number from 0 up has been seen.  It grows to
+// the largest number seen.
+
+struct Histogram
+{
+    Histogram() : n(0) {}
+    void add(int v);
+    void merge(const Histogram& other);
+      // The smallest v with at least the fraction q of the numbers <= v
+    int quantile(double q) const;
+
+    long long n;
+    std::vector<long long> counts;
+};
+
+// A confidence interval for a proportion
+
+struct Interval
+{
+    Interval() : low(0), high(1) {}
+    Interval(double l, double h) : low(l), high(h) {}
+    double low;
+    double high;
+};
+
+  // The Wilson score interval for successes out of trials, z standard
+  // errors wide on each side (1.96 for 95%).  Unlike the normal interval it
+  // stays within [0, 1] and is sensible near 0 and 1 and for few trials.
+Interval wilsonInterval(long long successes, long long trials, double z = 1.96);
+  // The normal approximation, p +- z * sqrt(p * (1 - p) / trials)
+Interval normalInterval(long long successes, long long trials, double z = 1.96);
+
+// What a match needs to know about one game.  Players are numbered as in
+// the match, not by who moved first.
+
+struct GameSummary
+{
+    int firstMover;                 // 0 or 1
+    int winner;                     // 0 or 1, or -1 if the game was not played
+    int shots[2];                   // fired by each player
+    std::vector<int> sunkAt[2];     // for each ship a player sank, the
+                                    // player's shot that sank it; 0 if never
+};
+
+struct MatchStats
+{
+    MatchStats() : games(0), undecided(0), firstMoverWins(0)
+    {
+        wins[0] = wins[1] = 0;
+    }
+    void record(const GameSummary& game);
+    void merge(const MatchStats& other);
+
+      // Of the games that were played
+    long long decided() const { return games - undecided; }
+    Interval winRate(int player, double z = 1.96) const;
+    Interval firstMoverRate(double z = 1.96) const;
+
+    long long games;
+    long long undecided;
+    long long wins[2];
+    long long firstMoverWins;
+    RunningStat shotsToWin[2];              // in the games each player won
+    Histogram shotsToWinCounts[2];
+    RunningStat shotsPerGame;               // by both players
+    std::vector<RunningStat> timeToSink[2]; // the shot each player sank
+                                            // each ship of the other with
+};
+
+#endif // MATCHSTATS_INCLUDED
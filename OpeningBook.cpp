@@ -0,0 +1,233 @@
+#include "OpeningBook.h"
+#include "PlacementTable.h"
+#include "Game.h"
+#include <cstdlib>
+#include <cstring>
+#include <fstream>
+#include <iterator>
+
+#if defined(__unix__) || defined(__APPLE__)
+#define BATTLESHIP_MMAP
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+using namespace std;
+
+static const char BOOK_MAGIC[8] = "BSBOOK1";
+
+//*********************************************************************
+//  OpeningBook
+//*********************************************************************
+
+OpeningBook::OpeningBook()
+ : m_mapped(nullptr), m_bytes(0), m_header(nullptr), m_lengths(nullptr),
+	m_slots(nullptr)
+{}
+
+OpeningBook::~OpeningBook()
+{
+#ifdef BATTLESHIP_MMAP
+	if (m_mapped != nullptr)
+		munmap(const_cast<char*>(m_mapped), m_bytes);
+#endif
+}
+
+static size_t lengthsBytes(uint32_t nShips)
+{
+	return (nShips * sizeof(uint32_t) + 7) / 8 * 8;
+}
+
+//Check that the file holds a whole book before pointing into it
+
+bool OpeningBook::attach(const char* data, size_t bytes)
+{
+	if (bytes < sizeof(BookHeader))
+		return false;
+	const BookHeader* header = reinterpret_cast<const BookHeader*>(data);
+	if (memcmp(header->magic, BOOK_MAGIC, sizeof(BOOK_MAGIC)) != 0)
+		return false;
+	if (header->nSlots == 0 || (header->nSlots & (header->nSlots - 1)) != 0 ||
+		header->nEntries >= header->nSlots || header->nShips > 1024)
+		return false;
+
+	const size_t lengthsAt = sizeof(BookHeader);
+	const size_t slotsAt = lengthsAt + lengthsBytes(header->nShips);
+	if (bytes < slotsAt || (bytes - slotsAt) / sizeof(BookEntry) != header->nSlots)
+		return false;
+
+	m_header = header;
+	m_lengths = reinterpret_cast<const uint32_t*>(data + lengthsAt);
+	m_slots = reinterpret_cast<const BookEntry*>(data + slotsAt);
+	return true;
+}
+
+shared_ptr<const OpeningBook> OpeningBook::open(const string& path)
+{
+	shared_ptr<OpeningBook> book(new OpeningBook);
+
+#ifdef BATTLESHIP_MMAP
+	const int fd = ::open(path.c_str(), O_RDONLY);
+	if (fd < 0)
+		return nullptr;
+	struct stat st;
+	if (fstat(fd, &st) != 0 || st.st_size <= 0)
+	{
+		close(fd);
+		return nullptr;
+	}
+	void* data = mmap(nullptr, st.st_size, PROT_READ, MAP_PRIVATE, fd, 0);
+	close(fd);
+	if (data == MAP_FAILED)
+		return nullptr;
+	book->m_mapped = static_cast<const char*>(data);
+	book->m_bytes = st.st_size;
+	if (!book->attach(book->m_mapped, book->m_bytes))
+		return nullptr;
+#else
+	ifstream in(path.c_str(), ios::binary);
+	if (!in)
+		return nullptr;
+	book->m_copy.assign(istreambuf_iterator<char>(in), istreambuf_iterator<char>());
+	if (!book->attach(book->m_copy.data(), book->m_copy.size()))
+		return nullptr;
+#endif
+
+	return book;
+}
+
+shared_ptr<const OpeningBook> OpeningBook::forGame(const Game& g)
+{
+	static const shared_ptr<const OpeningBook> book = [] {
+		const char* path = getenv("BATTLESHIP_BOOK");
+		return path != nullptr && *path != '\0' ? open(path) : nullptr;
+	}();
+
+	if (book == nullptr || !PlacementTable::fits(g.rows(), g.cols()) ||
+		!book->matches(g))
+		return nullptr;
+	return book;
+}
+
+bool OpeningBook::matches(const Game& g) const
+{
+	if (m_header->rows != static_cast<uint32_t>(g.rows()) ||
+		m_header->cols != static_cast<uint32_t>(g.cols()) ||
+		m_header->nShips != static_cast<uint32_t>(g.nShips()))
+		return false;
+	for (int s = 0; s < g.nShips(); s++)
+		if (m_lengths[s] != static_cast<uint32_t>(g.shipLength(s)))
+			return false;
+	return true;
+}
+
+//Slots are probed in order from the one the key picks, and an
+//empty slot ends the search
+
+bool OpeningBook::lookup(uint64_t key, int& move) const
+{
+	const uint64_t mask = m_header->nSlots - 1;
+	for (uint64_t slot = key & mask; ; slot = (slot + 1) & mask)
+	{
+		const BookEntry& entry = m_slots[slot];
+		if (entry.key == key)
+		{
+			move = static_cast<int>(entry.move);
+			return true;
+		}
+		if (entry.key == 0)
+			return false;
+	}
+}
+
+//The table is kept at most half full, so lookups stay short
+
+bool OpeningBook::write(const string& path, const Game& g,
+	const vector<BookEntry>& entries)
+{
+	uint64_t nSlots = 2;
+	while (nSlots < 2 * entries.size())
+		nSlots *= 2;
+
+	vector<BookEntry> slots(nSlots);
+	memset(slots.data(), 0, nSlots * sizeof(BookEntry));
+	uint64_t nEntries = 0;
+
+	for (size_t k = 0; k < entries.size(); k++)
+	{
+		if (entries[k].key == 0)
+			continue;
+		uint64_t slot = entries[k].key & (nSlots - 1);
+		while (slots[slot].key != 0 && slots[slot].key != entries[k].key)
+			slot = (slot + 1) & (nSlots - 1);
+		if (slots[slot].key == 0)
+			nEntries++;
+		slots[slot] = entries[k];
+	}
+
+	BookHeader header;
+	memset(&header, 0, sizeof(header));
+	memcpy(header.magic, BOOK_MAGIC, sizeof(BOOK_MAGIC));
+	header.rows = g.rows();
+	header.cols = g.cols();
+	header.nShips = g.nShips();
+	header.nSlots = nSlots;
+	header.nEntries = nEntries;
+
+	vector<char> lengths(lengthsBytes(header.nShips), 0);
+	for (int s = 0; s < g.nShips(); s++)
+	{
+		const uint32_t length = g.shipLength(s);
+		memcpy(&lengths[s * sizeof(uint32_t)], &length, sizeof(length));
+	}
+
+	ofstream out(path.c_str(), ios::binary | ios::trunc);
+	out.write(reinterpret_cast<const char*>(&header), sizeof(header));
+	out.write(lengths.data(), lengths.size());
+	out.write(reinterpret_cast<const char*>(slots.data()), nSlots * sizeof(BookEntry));
+	return static_cast<bool>(out);
+}
+
+//*********************************************************************
+//  BookLine
+//*********************************************************************
+
+BookLine::BookLine(const Game& g)
+ : m_book(OpeningBook::forGame(g)), m_key(g, BOOK_SALT),
+	m_nCells(g.rows() * g.cols())
+{}
+
+//Once a state is missing, no later state can be in the book,
+//so the book is let go
+
+int BookLine::move()
+{
+	if (m_book == nullptr)
+		return -1;
+
+	int cell;
+	if (m_book->lookup(m_key.key(), cell) && cell >= 0 && cell < m_nCells &&
+		!m_fired.test(cell))
+		return cell;
+
+	m_book.reset();
+	return -1;
+}
+
+void BookLine::record(int cell, bool shotHit, int sunkShip)
+{
+	if (m_book == nullptr)
+		return;
+
+	m_fired.set(cell);
+	if (!shotHit)
+		m_key.recordMiss(cell);
+	else
+	{
+		m_key.recordHit(cell);
+		if (sunkShip >= 0)
+			m_key.recordSink(cell, sunkShip);
+	}
+}
@@ -0,0 +1,105 @@
+
+#ifndef OPENINGBOOK_INCLUDED
+#define OPENINGBOOK_INCLUDED
+
+#include "Bitboard.h"
+#include "TranspositionTable.h"
+#include <cstdint>
+#include <cstddef>
+#include <memory>
+#include <string>
+#include <vector>
+
+class Game;
+
+// An OpeningBook holds precomputed moves for the first shots of a game on
+// one board size and fleet, keyed by the ShotKey of the shot state with
+// salt BOOK_SALT.  Books are made offline by tools/makebook.cpp and read
+// with mmap where the system has it, so opening a book costs no parsing
+// and looking a state up is one hash probe into the file.
+//
+// The file is a BookHeader, the ship lengths (one uint32 each, padded to a
+// multiple of 8 bytes), then an open-addressed hash table of BookEntry
+// slots, all in the byte order of the machine that wrote it.  A slot with
+// key 0 is empty.
+
+const std::uint64_t BOOK_SALT = 0x626f6f6bULL;
+
+struct BookHeader
+{
+    char magic[8];             // "BSBOOK1"
+    std::uint32_t rows;
+    std::uint32_t cols;
+    std::uint32_t nShips;
+    std::uint32_t reserved;
+    std::uint64_t nSlots;      // a power of two
+    std::uint64_t nEntries;
+};
+
+struct BookEntry
+{
+    std::uint64_t key;
+    std::uint32_t move;        // cell to fire at
+    std::uint32_t quality;     // fleets sampled to choose it
+};
+
+class OpeningBook
+{
+public:
+      // The book named by the BATTLESHIP_BOOK environment variable, if it
+      // was made for the game's board and fleet; otherwise nullptr.  The
+      // file is opened once per process.
+    static std::shared_ptr<const OpeningBook> forGame(const Game& g);
+
+      // nullptr if the file cannot be read or is not a book
+    static std::shared_ptr<const OpeningBook> open(const std::string& path);
+
+      // Write a book for the game's board and fleet; false on failure
+    static bool write(const std::string& path, const Game& g,
+                      const std::vector<BookEntry>& entries);
+
+    ~OpeningBook();
+
+    bool matches(const Game& g) const;
+    std::size_t size() const { return static_cast<std::size_t>(m_header->nEntries); }
+
+      // If the state is in the book, set move and return true
+    bool lookup(std::uint64_t key, int& move) const;
+
+    OpeningBook(const OpeningBook&) = delete;
+    OpeningBook& operator=(const OpeningBook&) = delete;
+
+private:
+    OpeningBook();
+    bool attach(const char* data, std::size_t bytes);
+
+    const char* m_mapped;            // the mapping, if the file is mapped
+    std::size_t m_bytes;
+    std::vector<char> m_copy;        // the file, if it is not
+    const BookHeader* m_header;
+    const std::uint32_t* m_lengths;
+    const BookEntry* m_slots;
+};
+
+// A BookLine follows one player's game through the book for the game's
+// board and fleet, if there is one, until the shots leave it.
+
+class BookLine
+{
+public:
+    BookLine(const Game& g);
+
+      // The book's move for the shots so far, or -1 once play has left
+      // the book
+    int move();
+      // Record a valid shot; sunkShip is the id of the ship it sank, or -1
+    void record(int cell, bool shotHit, int sunkShip);
+
+private:
+    std::shared_ptr<const OpeningBook> m_book;
+    ShotKey m_key;
+    Bitboard m_fired;
+    int m_nCells;
+};
+
+#endif // OPENINGBOOK_INCLUDED
@@ -0,0 +1,146 @@
+#include "PlacementSolver.h"
+#include "Game.h"
+#include "PlacementTable.h"
+#include "Counters.h"
+
+using namespace std;
+
+class PlacementSearch
+{
+public:
+	PlacementSearch(const Game& g, const Bitboard& blocked);
+	bool solve(vector<ShipPlacement>& placements);
+
+private:
+	bool extend(const Bitboard& used, int freeCells, int lengthLeft);
+
+	const Game& m_game;
+	shared_ptr<const PlacementTable> m_table;
+	//The placements of each ship that miss the blocked cells,
+	//as indexes into the table
+
+	vector< vector<int> > m_candidates;
+	vector<int> m_chosen;
+	int m_freeCells;    // cells that are not blocked
+	int m_depth;        // ships placed so far
+};
+
+//The blocked cells never change during the search, so the
+//placements that touch them are dropped once, up front. The
+//rest are tried cell by cell in row-major order, horizontal
+//before vertical, rather than in the table's order, which
+//would put every ship across the top rows.
+
+PlacementSearch::PlacementSearch(const Game& g, const Bitboard& blocked)
+ : m_game(g), m_table(PlacementTable::forGame(g)), m_candidates(g.nShips()),
+	m_chosen(g.nShips(), -1),
+	m_freeCells(g.rows() * g.cols() - blocked.count()), m_depth(0)
+{
+	for (int s = 0; s < g.nShips(); s++)
+	{
+		const Bitboard* masks = m_table->masks(s);
+		for (int r = 0; r < g.rows(); r++)
+		{
+			for (int c = 0; c < g.cols(); c++)
+			{
+				for (int d = 0; d < 2; d++)
+				{
+					const int k = m_table->indexOf(s, Point(r, c), d == 0 ? HORIZONTAL : VERTICAL);
+					if (k >= 0 && !masks[k].intersects(blocked))
+						m_candidates[s].push_back(k);
+				}
+			}
+		}
+	}
+}
+
+//Place one more ship, taking them from the last id down and
+//trying each in candidate order, so the first fleet found is
+//the one a plain backtracking search finds. A ship with no
+//room left ends the branch, as does running out of free cells
+//for the ships still to be placed.
+
+bool PlacementSearch::extend(const Bitboard& used, int freeCells, int lengthLeft)
+{
+	BATTLESHIP_COUNT(m_game, solverNodes, 1);
+	BATTLESHIP_COUNT_MAX(m_game, solverMaxDepth, m_depth);
+
+	if (lengthLeft == 0)
+		return true;
+	if (lengthLeft > freeCells)
+	{
+		BATTLESHIP_COUNT(m_game, solverBacktracks, 1);
+		return false;
+	}
+
+	const int ship = m_game.nShips() - 1 - m_depth;
+
+	for (int s = 0; s <= ship; s++)
+	{
+		const Bitboard* masks = m_table->masks(s);
+		size_t k = 0;
+		while (k < m_candidates[s].size() && masks[m_candidates[s][k]].intersects(used))
+			k++;
+
+		if (k == m_candidates[s].size())
+		{
+			BATTLESHIP_COUNT(m_game, solverBacktracks, 1);
+			return false;
+		}
+	}
+
+	const int length = m_game.shipLength(ship);
+	m_depth++;
+
+	const Bitboard* masks = m_table->masks(ship);
+
+	for (size_t k = 0; k < m_candidates[ship].size(); k++)
+	{
+		const Bitboard& mask = masks[m_candidates[ship][k]];
+		if (mask.intersects(used))
+			continue;
+
+		m_chosen[ship] = m_candidates[ship][k];
+		if (extend(used | mask, freeCells - length, lengthLeft - length))
+			return true;
+	}
+
+	m_depth--;
+	BATTLESHIP_COUNT(m_game, solverBacktracks, 1);
+	return false;
+}
+
+bool PlacementSearch::solve(vector<ShipPlacement>& placements)
+{
+	int lengthLeft = 0;
+	for (int s = 0; s < m_game.nShips(); s++)
+		lengthLeft += m_game.shipLength(s);
+
+#ifdef BATTLESHIP_COUNTERS
+	const long long nodesBefore = m_game.counters().solverNodes;
+	const bool solved = extend(Bitboard(), m_freeCells, lengthLeft);
+	BATTLESHIP_COUNT(m_game, solverCalls, 1);
+	BATTLESHIP_COUNT_MAX(m_game, solverMaxNodes,
+		m_game.counters().solverNodes - nodesBefore);
+#else
+	const bool solved = extend(Bitboard(), m_freeCells, lengthLeft);
+#endif
+	if (!solved)
+		return false;
+
+	placements.resize(m_game.nShips());
+	for (int s = 0; s < m_game.nShips(); s++)
+		placements[s] = m_table->placement(s, m_chosen[s]);
+
+	return true;
+}
+
+bool solvePlacement(const Game& g, const Bitboard& blocked,
+	vector<ShipPlacement>& placements)
+{
+	if (!PlacementTable::fits(g.rows(), g.cols()))
+		return false;
+
+	PlacementSearch search(g, blocked);
+	return search.solve(placements);
+}
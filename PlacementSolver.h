@@ -0,0 +1,37 @@
+
+#ifndef PLACEMENTSOLVER_INCLUDED
+#define PLACEMENTSOLVER_INCLUDED
+
+#include "globals.h"
+#include "Bitboard.h"
+#include <vector>
+
+class Game;
+
+// Where one ship goes on a board
+
+struct ShipPlacement
+{
+    ShipPlacement() : dir(HORIZONTAL) {}
+    ShipPlacement(Point p, Direction d) : topOrLeft(p), dir(d) {}
+    Point topOrLeft;
+    Direction dir;
+};
+
+// Find a position for every ship of g, indexed by ship id, such that no
+// two ships overlap and no ship covers a cell of blocked.  The answer is
+// the one a plain backtracking search would give: ships are placed from
+// the last id down, each at the first cell in row-major order where it
+// fits, trying horizontal before vertical at each cell.  With blocked
+// drawn at random, this spreads the fleet over the free cells the way
+// MediocrePlayer always has.  The search works on precomputed placement
+// masks and abandons a branch as soon as some ship has no room left or
+// the remaining ships cannot fit in the remaining free cells, which never
+// changes the answer.  The search is exhaustive, so false means that no
+// such placement exists.  Only boards that fit in a Bitboard can be
+// solved; for larger ones the result is always false.
+
+bool solvePlacement(const Game& g, const Bitboard& blocked,
+                    std::vector<ShipPlacement>& placements);
+
+#endif // PLACEMENTSOLVER_INCLUDED
@@ -0,0 +1,159 @@
+#include "PlacementTable.h"
+#include "Game.h"
+#include <map>
+#include <mutex>
+
+using namespace std;
+
+PlacementTable::PlacementTable(int rows, int cols, const vector<int>& shipLength)
+ : m_rows(rows), m_cols(cols), m_shipLength(shipLength)
+{
+	vector<int> lengths;
+
+	for (size_t s = 0; s < shipLength.size(); s++)
+	{
+		const int length = shipLength[s];
+		size_t k = 0;
+		while (k < lengths.size() && lengths[k] != length)
+			k++;
+		m_lengthIndex.push_back(static_cast<int>(k));
+		if (k < lengths.size())
+			continue;
+
+		lengths.push_back(length);
+		m_masks.push_back(vector<Bitboard>());
+		vector<Bitboard>& masks = m_masks.back();
+
+		for (int r = 0; r < rows; r++)
+		{
+			for (int c = 0; c + length <= cols; c++)
+			{
+				Bitboard mask;
+				for (int j = 0; j < length; j++)
+					mask.set(r * cols + c + j);
+				masks.push_back(mask);
+			}
+		}
+
+		for (int r = 0; r + length <= rows; r++)
+		{
+			for (int c = 0; c < cols; c++)
+			{
+				Bitboard mask;
+				for (int j = 0; j < length; j++)
+					mask.set((r + j) * cols + c);
+				masks.push_back(mask);
+			}
+		}
+	}
+
+	//Count the placements over each cell, then fill them in
+
+	const int nCells = rows * cols;
+
+	for (size_t cls = 0; cls < m_masks.size(); cls++)
+	{
+		const vector<Bitboard>& masks = m_masks[cls];
+		vector<int> start(nCells + 1, 0);
+
+		for (size_t k = 0; k < masks.size(); k++)
+			for (int cell = 0; cell < nCells; cell++)
+				if (masks[k].test(cell))
+					start[cell + 1]++;
+		for (int cell = 0; cell < nCells; cell++)
+			start[cell + 1] += start[cell];
+
+		vector<int> cover(start[nCells]);
+		vector<int> next(start.begin(), start.end() - 1);
+		const size_t words = (masks.size() + 63) / 64;
+		vector<uint64_t> bits(nCells * words, 0);
+		for (size_t k = 0; k < masks.size(); k++)
+		{
+			for (int cell = 0; cell < nCells; cell++)
+			{
+				if (masks[k].test(cell))
+				{
+					cover[next[cell]++] = static_cast<int>(k);
+					bits[cell * words + k / 64] |= uint64_t(1) << (k % 64);
+				}
+			}
+		}
+
+		m_coverStart.push_back(start);
+		m_cover.push_back(cover);
+		m_coverBits.push_back(bits);
+	}
+}
+
+//The placements are laid out so that this is pure arithmetic
+
+ShipPlacement PlacementTable::placement(int shipId, int k) const
+{
+	const int length = m_shipLength[shipId];
+	const int perRow = m_cols - length + 1;
+	const int nHorizontal = perRow > 0 ? m_rows * perRow : 0;
+
+	if (k < nHorizontal)
+		return ShipPlacement(Point(k / perRow, k % perRow), HORIZONTAL);
+
+	k -= nHorizontal;
+	return ShipPlacement(Point(k / m_cols, k % m_cols), VERTICAL);
+}
+
+int PlacementTable::indexOf(int shipId, Point topOrLeft, Direction dir) const
+{
+	const int length = m_shipLength[shipId];
+	const int r = topOrLeft.r;
+	const int c = topOrLeft.c;
+	const int perRow = m_cols - length + 1;
+	const int nHorizontal = perRow > 0 ? m_rows * perRow : 0;
+
+	if (r < 0 || c < 0)
+		return -1;
+
+	if (dir == HORIZONTAL)
+	{
+		if (r >= m_rows || c + length > m_cols)
+			return -1;
+		return r * perRow + c;
+	}
+
+	else if (dir == VERTICAL)
+	{
+		if (r + length > m_rows || c >= m_cols)
+			return -1;
+		return nHorizontal + r * m_cols + c;
+	}
+
+	return -1;
+}
+
+shared_ptr<const PlacementTable> PlacementTable::forGame(const Game& g)
+{
+	return g.placementTable();
+}
+
+//Tables are built on first use and kept for the life of the
+//program. A table is built under the lock, so two threads
+//asking for a new one at once build it only once.
+
+shared_ptr<const PlacementTable> PlacementTable::lookup(int rows, int cols,
+	const vector<int>& shipLength)
+{
+	if (!fits(rows, cols))
+		return nullptr;
+
+	vector<int> key;
+	key.push_back(rows);
+	key.push_back(cols);
+	key.insert(key.end(), shipLength.begin(), shipLength.end());
+
+	static mutex tablesLock;
+	static map< vector<int>, shared_ptr<const PlacementTable> > tables;
+
+	lock_guard<mutex> lock(tablesLock);
+	shared_ptr<const PlacementTable>& table = tables[key];
+	if (table == nullptr)
+		table.reset(new PlacementTable(rows, cols, shipLength));
+	return table;
+}
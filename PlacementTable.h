@@ -0,0 +1,111 @@
+
+#ifndef PLACEMENTTABLE_INCLUDED
+#define PLACEMENTTABLE_INCLUDED
+
+#include "globals.h"
+#include "Bitboard.h"
+#include "PlacementSolver.h"
+#include <vector>
+#include <memory>
+#include <cstdint>
+
+class Game;
+
+// A PlacementTable lists every position of every ship of a game as a
+// Bitboard of the cells it covers.  For a ship of length L, the horizontal
+// placements come first, in row-major order of their leftmost cell, then
+// the vertical ones in row-major order of their topmost cell, so the index
+// of a placement can be computed directly from its position.
+//
+// Each cell also has an index of the placements that cover it, so that a
+// shot can be applied to just the placements it affects.
+//
+// A table depends only on the board size and the ship lengths.  lookup
+// builds each distinct table once and hands out the same read-only copy to
+// every board, player and thread that asks for it.  Each Game looks its
+// table up once and keeps it, so forGame takes no lock after the first
+// time a game asks.
+
+class PlacementTable
+{
+public:
+      // The table of g's board and fleet, as kept by g; nullptr if the
+      // board is too large for a Bitboard
+    static std::shared_ptr<const PlacementTable> forGame(const Game& g);
+      // The table shared by every game with this board and fleet
+    static std::shared_ptr<const PlacementTable> lookup(int rows, int cols,
+                                                        const std::vector<int>& shipLength);
+
+    static bool fits(int rows, int cols)
+    {
+        return rows * cols <= BITBOARD_WORDS * 64;
+    }
+
+    int rows() const { return m_rows; }
+    int cols() const { return m_cols; }
+    int nShips() const { return static_cast<int>(m_shipLength.size()); }
+    int shipLength(int shipId) const { return m_shipLength[shipId]; }
+
+      // Number of placements of the ship, and their masks
+    int count(int shipId) const
+    {
+        return static_cast<int>(m_masks[m_lengthIndex[shipId]].size());
+    }
+    const Bitboard* masks(int shipId) const
+    {
+        return m_masks[m_lengthIndex[shipId]].data();
+    }
+    const Bitboard& mask(int shipId, int k) const { return masks(shipId)[k]; }
+
+      // Ships of the same length share a length class, numbered from 0 in
+      // order of their first ship
+    int nLengthClasses() const { return static_cast<int>(m_masks.size()); }
+    int lengthClass(int shipId) const { return m_lengthIndex[shipId]; }
+
+      // The placements of the ship that cover the cell, as indexes into
+      // masks(shipId)
+    int coveringCount(int shipId, int cell) const
+    {
+        const std::vector<int>& start = m_coverStart[m_lengthIndex[shipId]];
+        return start[cell + 1] - start[cell];
+    }
+    const int* covering(int shipId, int cell) const
+    {
+        const int cls = m_lengthIndex[shipId];
+        return m_cover[cls].data() + m_coverStart[cls][cell];
+    }
+      // The same placements as a set of bits, coverWords(shipId) words
+      // long, with bit k standing for placement k
+    int coverWords(int shipId) const
+    {
+        return (count(shipId) + 63) / 64;
+    }
+    const std::uint64_t* coverBits(int shipId, int cell) const
+    {
+        return m_coverBits[m_lengthIndex[shipId]].data() + cell * coverWords(shipId);
+    }
+
+      // The position of placement k of the ship
+    ShipPlacement placement(int shipId, int k) const;
+
+      // The index of the ship's placement at topOrLeft, or -1 if the ship
+      // would not lie entirely on the board there
+    int indexOf(int shipId, Point topOrLeft, Direction dir) const;
+
+private:
+    PlacementTable(int rows, int cols, const std::vector<int>& shipLength);
+
+    int m_rows;
+    int m_cols;
+    std::vector<int> m_shipLength;
+      // Ships of the same length share their masks
+    std::vector<int> m_lengthIndex;
+    std::vector< std::vector<Bitboard> > m_masks;
+      // For each length class, the placements covering cell k are
+      // m_cover[m_coverStart[k]] up to m_cover[m_coverStart[k+1]]
+    std::vector< std::vector<int> > m_coverStart;
+    std::vector< std::vector<int> > m_cover;
+    std::vector< std::vector<std::uint64_t> > m_coverBits;
+};
+
+#endif // PLACEMENTTABLE_INCLUDED
@@ -1,869 +1,1222 @@
-#include "Player.h"
-#include "Board.h"
-#include "Game.h"
-#include "globals.h"
-#include <iostream>
-#include <string>
-#include <chrono>
-
-using namespace std;
-
-//*********************************************************************
-//  Timer Code
-//*********************************************************************
-
-//========================================================================
-// Timer t;                 // create a timer and start it
-// t.start();               // start the timer
-// double d = t.elapsed();  // milliseconds since timer was last started
-//========================================================================
-
-class Timer
-{
-public:
-	Timer()
-	{
-		start();
-	}
-	void start()
-	{
-		m_time = std::chrono::high_resolution_clock::now();
-	}
-	double elapsed() const
-	{
-		std::chrono::duration<double, std::milli> diff =
-			std::chrono::high_resolution_clock::now() - m_time;
-		return diff.count();
-	}
-private:
-	std::chrono::high_resolution_clock::time_point m_time;
-};
-
-//*********************************************************************
-//  AwfulPlayer
-//*********************************************************************
-
-class AwfulPlayer : public Player
-{
-public:
-	AwfulPlayer(string nm, const Game& g);
-	virtual bool placeShips(Board& b);
-	virtual Point recommendAttack();
-	virtual void recordAttackResult(Point p, bool validShot, bool shotHit,
-		bool shipDestroyed, int shipId);
-	virtual void recordAttackByOpponent(Point p);
-private:
-	Point m_lastCellAttacked;
-};
-
-AwfulPlayer::AwfulPlayer(string nm, const Game& g)
-	: Player(nm, g), m_lastCellAttacked(0, 0)
-{}
-
-bool AwfulPlayer::placeShips(Board& b)
-{
-	// Clustering ships is bad strategy
-	for (int k = 0; k < game().nShips(); k++)
-		if (!b.placeShip(Point(k, 0), k, HORIZONTAL))
-			return false;
-	return true;
-}
-
-Point AwfulPlayer::recommendAttack()
-{
-	if (m_lastCellAttacked.c > 0)
-		m_lastCellAttacked.c--;
-	else
-	{
-		m_lastCellAttacked.c = game().cols() - 1;
-		if (m_lastCellAttacked.r > 0)
-			m_lastCellAttacked.r--;
-		else
-			m_lastCellAttacked.r = game().rows() - 1;
-	}
-	return m_lastCellAttacked;
-}
-
-void AwfulPlayer::recordAttackResult(Point /* p */, bool /* validShot */,
-	bool /* shotHit */, bool /* shipDestroyed */,
-	int /* shipId */)
-{
-	// AwfulPlayer completely ignores the result of any attack
-}
-
-void AwfulPlayer::recordAttackByOpponent(Point /* p */)
-{
-	// AwfulPlayer completely ignores what the opponent does
-}
-
-//*********************************************************************
-//  HumanPlayer
-//*********************************************************************
-
-bool getLineWithTwoIntegers(int& r, int& c)
-{
-	bool result(cin >> r >> c);
-	if (!result)
-		cin.clear();  // clear error state so can do more input operations
-	cin.ignore(10000, '\n');
-	return result;
-}
-
-class HumanPlayer : public Player
-{
-public:
-	HumanPlayer(string nm, const Game& g);
-	virtual ~HumanPlayer() {}
-
-	virtual bool isHuman() const { return true; }
-
-	virtual bool placeShips(Board& b);
-	virtual Point recommendAttack();
-	virtual void recordAttackResult(Point p, bool validShot, bool shotHit,
-		bool shipDestroyed, int shipId) {}
-	virtual void recordAttackByOpponent(Point p) {}
-
-};
-
-HumanPlayer::HumanPlayer(string nm, const Game& g)
-	:Player(nm, g)
-{}
-
-bool HumanPlayer::placeShips(Board& b)
-{
-	cout << this->name() << " must place 5 ships." << endl;
-	b.clear();
-	b.display(false);
-	bool badInput = false;
-
-	for (int k = 0; k < 5; k++)
-	{
-		string output;
-
-		switch (k)
-		{
-		case 0:
-			output = "aircraft carrier (length 5):";
-			break;
-		case 1:
-			output = "battleship (length 4):";
-			break;
-		case 2:
-			output = "destroyer (length 3):";
-			break;
-		case 3:
-			output = "submarine (length 3):";
-			break;
-		case 4:
-			output = "patrol ship (length 2):";
-			break;
-		}
-
-		while (true)
-		{
-			if (k != 0 && !badInput)
-				cin.ignore(100000000, '\n');
-
-			badInput = false;
-
-			string input;
-			int row, col;
-			cout << "Enter h or v for direction of " << output;
-			getline(cin, input);
-
-			if (input[0] == 'h')
-			{
-				while (true)
-				{
-					cout << "Enter row and column of leftmost cell (e.g. 3 5):";
-					cin >> row >> col;
-					if (cin.fail())
-					{
-						cin.clear();
-						cin.ignore();
-						cout << "You must input two integers." << endl;
-						continue;
-					}
-
-					Point p(row, col);
-					if (!b.placeShip(p, k, HORIZONTAL))
-					{
-						cout << "The ship cannot be placed there" << endl;
-						continue;
-					}
-					break;
-				}
-				break;
-			}
-
-			else if (input[0] == 'v')
-			{
-				while (true)
-				{
-					cout << "Enter row and column of topmost cell (e.g. 3 5):";
-					cin >> row >> col;
-					if (cin.fail())
-					{
-						cin.clear();
-						cin.ignore();
-						cout << "You must input two integers." << endl;
-						continue;
-					}
-					Point p(row, col);
-					if (!b.placeShip(p, k, VERTICAL))
-					{
-						cout << "The ship cannot be placed there" << endl;
-						badInput = true;
-						continue;
-					}
-
-					break;
-				}
-				break;
-			}
-
-			else
-			{
-				cout << "Direction must be h or v." << endl;
-				continue;
-			}
-		}
-
-		if (k != 4)
-			b.display(false);
-	}
-
-	cin.ignore();
-
-	return true;
-}
-
-Point HumanPlayer::recommendAttack()
-{
-
-	int row, col;
-
-	while (true)
-	{
-		cout << "Enter the row and column to attack (e.g, 3 5):";
-		cin >> row >> col;
-		if (cin.fail())
-		{
-			cin.clear();
-			cin.ignore();
-			cout << "You must input two integers." << endl;
-			continue;
-		}
-
-		Point p(row, col);
-
-		return p;
-	}
-
-	Point p(0, 0);
-
-	return p;
-}
-
-//*********************************************************************
-//  MediocrePlayer
-//*********************************************************************
-
-class MediocrePlayer : public Player
-{
-public:
-	MediocrePlayer(string nm, const Game& g);
-	virtual ~MediocrePlayer() {}
-
-	virtual bool isHuman() const { return false; }
-	virtual bool placeShips(Board& b);
-	virtual Point recommendAttack();
-	virtual void recordAttackResult(Point p, bool validShot, bool shotHit,
-		bool shipDestroyed, int shipId);
-	virtual void recordAttackByOpponent(Point p) {}
-
-private:
-	bool doesPlace(int shipId, Board& b);
-	bool didFire(const Point& p) const;
-	bool inBound(const Point& p) const;
-	bool inStateOne;
-
-	Point attackResults[100];
-	Point currentPoint;
-	int attacks;
-
-};
-
-MediocrePlayer::MediocrePlayer(string nm, const Game& g)
-	:Player(nm, g), inStateOne(true), attacks(0)
-{}
-
-///////////////////////////////////////////
-//              Helper Functions
-///////////////////////////////////////////
-
-//	This function checks wheather the 
-//	given point falls into the attack range or not
-
-bool MediocrePlayer::inBound(const Point& p) const
-{
-	if (p.c == currentPoint.c)
-	{
-		const int vertical = p.r - currentPoint.r;
-		if (vertical <= 4 && vertical >= -4)
-			return true;
-	}
-
-	if (p.r == currentPoint.r)
-	{
-		const int horizontal = p.c - currentPoint.c;
-		if (horizontal <= 4 && horizontal >= -4)
-			return true;
-	}
-
-	return false;
-}
-
-//	This helper function determines whether the give point has been fired or not
-
-bool MediocrePlayer::didFire(const Point& p) const
-{
-	for (int k = 0; k < attacks; k++)
-		if (p.r == attackResults[k].r && p.c == attackResults[k].c)
-			return true;
-
-	return false;
-}
-
-//	This helper function places all ships in a recursive manner
-
-bool MediocrePlayer::doesPlace(int shipId, Board& b)
-{
-	if (shipId < 0)
-		return true;
-
-	const int rows = game().rows();
-	const int cols = game().cols();
-
-	const int newId = shipId - 1;
-
-	for (int k = 0; k < rows; k++)
-	{
-		for (int j = 0; j < cols; j++)
-		{
-			Point p(k, j);
-
-			if (b.placeShip(p, shipId, HORIZONTAL))
-			{
-				if (!doesPlace(newId, b))
-					b.unplaceShip(p, shipId, HORIZONTAL);
-				else
-					return true;
-			}
-
-			if (b.placeShip(p, shipId, VERTICAL))
-			{
-				if (!doesPlace(newId, b))
-					b.unplaceShip(p, shipId, VERTICAL);
-				else
-					return true;
-			}
-		}
-	}
-
-	return false;
-}
-
-///////////////////////////////////////////
-//     Public Interface Implementation
-///////////////////////////////////////////
-
-bool MediocrePlayer::placeShips(Board& b)
-{
-	const int shipId = game().nShips() - 1;
-
-	for (int k = 0; k < 50; k++)
-	{
-		b.block();
-
-		if (doesPlace(shipId, b))
-		{
-			b.unblock();
-			return true;
-		}
-
-		b.unblock();
-	}
-
-	return false;
-}
-
-
-Point MediocrePlayer::recommendAttack()
-{
-	if (inStateOne)
-	{
-		while (true)
-		{
-			Point p = game().randomPoint();
-			if (!didFire(p))
-				return p;
-		}
-	}
-	else
-	{
-		while (true)
-		{
-			Point p = game().randomPoint();
-			if (!didFire(p) && inBound(p))
-				return p;
-		}
-	}
-}
-
-void MediocrePlayer::recordAttackResult(Point p, bool validShot, bool shotHit,
-	bool shipDestroyed, int shipId)
-{
-	if (!validShot)
-		return;
-
-	attackResults[attacks] = p;
-	attacks++;
-
-	if (shotHit && !shipDestroyed && inStateOne)
-	{
-		inStateOne = false;
-		currentPoint = p;
-	}
-
-	else if (shotHit && shipDestroyed)
-		inStateOne = true;
-
-	return;
-}
-
-//*********************************************************************
-//  GoodPlayer
-//*********************************************************************
-
-class GoodPlayer : public Player
-{
-public:
-	GoodPlayer(string nm, const Game& g);
-	virtual ~GoodPlayer() {}
-
-	virtual bool isHuman() const { return false; }
-	virtual bool placeShips(Board& b);
-	virtual Point recommendAttack();
-	virtual void recordAttackResult(Point p, bool validShot, bool shotHit,
-		bool shipDestroyed, int shipId);
-	virtual void recordAttackByOpponent(Point p);
-
-private:
-	Point attackResults[100];
-	Point hitResults[100];
-	Point currentPoint;
-
-	int limit;
-	int attacks;
-	int hits;
-
-	bool inStateOne;
-	bool awefulPlayer;
-	bool lastAction;
-	bool escape;
-	bool didFire(const Point& p) const;
-	bool didHit(const Point& p) const;
-	bool isUnique(const Point& p) const;
-	bool isNear(const Point& p) const;
-	bool isNext(const Point& p) const;
-	bool isHorizontal() const;
-	bool isVertical() const;
-	bool inBound(const Point& p);
-	bool inBound(const Point& p, Direction dir);
-};
-
-GoodPlayer::GoodPlayer(string nm, const Game& g)
-	:Player(nm, g), attacks(0), hits(0), limit(1),
-	inStateOne(true), awefulPlayer(false), lastAction(false),
-	escape(false)
-{}
-
-///////////////////////////////////////////
-//              Helper Functions
-///////////////////////////////////////////
-
-//This helper function determines whether a point
-//has been fired or not
-
-bool GoodPlayer::didFire(const Point& p) const
-{
-	for (int k = 0; k < attacks; k++)
-		if (p.r == attackResults[k].r && p.c == attackResults[k].c)
-			return true;
-
-	return false;
-}
-
-//This helper function determines whether a ship
-//has been hit in the point or not
-
-bool GoodPlayer::didHit(const Point& p) const
-{
-	for (int k = 0; k < hits; k++)
-		if (p.r == hitResults[k].r && p.c == hitResults[k].c)
-			return true;
-
-	return false;
-}
-
-//This helper function determines whether a point's
-//coordinates are both odd or both even. This is a 
-//useful standard in attacking under state 1. However
-//there are special cases involved. Following two helper
-//functions help dignose those special cases
-
-bool GoodPlayer::isUnique(const Point& p) const
-{
-	const int row = p.r;
-	const int col = p.c;
-
-	if (row % 2 != 0)
-	{
-		if (col % 2 != 0)
-			return true;
-	}
-
-	else
-	{
-		if (col % 2 == 0)
-			return true;
-	}
-
-	return false;
-}
-
-//This is one of the helper function that I used 
-//in attacking under state 1 in order to avoid
-//special cases
-
-bool GoodPlayer::isNear(const Point& p) const
-{
-	Point p1(p.r, p.c + 1);
-	Point p2(p.r, p.c - 1);
-	Point p3(p.r + 1, p.c);
-	Point p4(p.r - 1, p.c);
-
-	if (didHit(p1) || didHit(p2) || didHit(p3) || didHit(p4))
-		return true;
-
-	return false;
-}
-
-//Same as above
-
-bool GoodPlayer::isNext(const Point& p) const
-{
-	Point p11(p.r, p.c + 1);
-	Point p12(p.r, p.c + 2);
-	Point p21(p.r, p.c - 1);
-	Point p22(p.r, p.c - 2);
-	Point p31(p.r + 1, p.c);
-	Point p32(p.r + 2, p.c);
-	Point p41(p.r - 1, p.c);
-	Point p42(p.r - 2, p.c);
-
-	if ((didHit(p11) && didHit(p12)) || (didHit(p21) && didHit(p22)) ||
-		(didHit(p31) && didHit(p32)) || (didHit(p41) && didHit(p42)))
-		return true;
-
-	return false;
-}
-
-//This function checks whether the point given
-//is within the range away from the first hit 
-//point regardless of direction.
-
-bool GoodPlayer::inBound(const Point& p)
-{
-	if (limit > 4)
-		limit = 4;
-
-	if (p.c == currentPoint.c)
-	{
-		const int vertical = p.r - currentPoint.r;
-		if (vertical <= limit && vertical >= -limit)
-			return true;
-	}
-
-	if (p.r == currentPoint.r)
-	{
-		const int horizontal = p.c - currentPoint.c;
-		if (horizontal <= limit && horizontal >= -limit)
-			return true;
-	}
-
-	return false;
-}
-
-//This function checks if the point is within the
-//range of attack from the first hit point, taking
-//directions into account.
-
-bool GoodPlayer::inBound(const Point& p, Direction dir)
-{
-	if (limit > 4)
-		limit = 4;
-
-	if (dir == HORIZONTAL)
-	{
-		if (p.r == currentPoint.r)
-		{
-			const int horizontal = p.c - currentPoint.c;
-			if (horizontal <= limit && horizontal >= -limit)
-				return true;
-		}
-	}
-
-	if (dir == VERTICAL)
-	{
-		if (p.c == currentPoint.c)
-		{
-			const int vertical = p.r - currentPoint.r;
-			if (vertical <= limit && vertical >= -limit)
-				return true;
-		}
-	}
-
-	return false;
-}
-
-//This helper function checks if the opponent's
-//ship is placed horizontally.
-
-bool GoodPlayer::isHorizontal() const
-{
-	Point p1(currentPoint.r, currentPoint.c - 1);
-	Point p2(currentPoint.r, currentPoint.c + 1);
-	if (didHit(p1) || didHit(p2))
-		return true;
-
-	return false;
-}
-
-//This helper function checks if the opponent's
-//ship is placed vertically.
-
-bool GoodPlayer::isVertical() const
-{
-	Point p1(currentPoint.r - 1, currentPoint.c);
-	Point p2(currentPoint.r + 1, currentPoint.c);
-	if (didHit(p1) || didHit(p2))
-		return true;
-
-	return false;
-}
-
-///////////////////////////////////////////
-//    Public Interface Implementation
-///////////////////////////////////////////
-
-bool GoodPlayer::placeShips(Board& b)
-{
-	const int nShips = game().nShips();
-
-	for (int k = 0; k < nShips; k++)
-	{
-		while (true)
-		{
-			Point p = game().randomPoint();
-			const int a = rand() % 2;
-
-			//Let the directin of placement to 
-			//be determined by randomness
-
-			if (a == 0)
-			{
-				if (b.placeShip(p, k, HORIZONTAL))
-					break;
-				else
-					continue;
-			}
-
-			else
-			{
-				if (b.placeShip(p, k, VERTICAL))
-					break;
-				else
-					continue;
-			}
-		}
-	}
-
-	return true;
-}
-
-Point GoodPlayer::recommendAttack()
-{
-	if (inStateOne)
-	{
-		if (!escape)
-		{
-			int count = 0;
-			while (true)
-			{
-				count++;
-				Point p = game().randomPoint();
-
-				//The following if statement cosiders one of
-				//the special cases
-
-				if (!didFire(p) && isUnique(p) || !didFire(p) && isNext(p))
-					return p;
-
-				//If the function could not find a suitable
-				//point for attack after 120 trials, there
-				//must be a speical case
-
-				if (count == 120)
-				{
-					escape = true;
-					break;
-				}
-			}
-		}
-
-		//This deals with the special case
-
-		while (true)
-		{
-			Point p = game().randomPoint();
-			if (!didFire(p) && isUnique(p) || !didFire(p) && isNear(p))
-				return p;
-		}
-
-	}
-
-	else
-	{
-		if (!lastAction)
-		{
-			if (isHorizontal())
-			{
-				int count = 0;
-				while (true)
-				{
-					count++;
-					Point p = game().randomPoint();
-					if (!didFire(p) && inBound(p, HORIZONTAL))
-						return p;
-					if (count == 50)
-					{
-						lastAction = true;
-						break;
-					}
-				}
-			}
-
-			if (isVertical())
-			{
-				int count = 0;
-				while (true)
-				{
-					count++;
-					Point p = game().randomPoint();
-					if (!didFire(p) && inBound(p, VERTICAL))
-						return p;
-					if (count == 50)
-					{
-						lastAction = true;
-						break;
-					}
-				}
-			}
-		}
-
-		int count = 0;
-		while (true)
-		{
-			count++;
-			Point p = game().randomPoint();
-			if (!didFire(p) && inBound(p))
-				return p;
-			if (count == 60)
-			{
-				count = 0;
-				limit++;
-			}
-		}
-	}
-}
-
-void GoodPlayer::recordAttackResult(Point p, bool validShot, bool shotHit,
-	bool shipDestroyed, int shipId)
-{
-	if (!validShot)
-		return;
-
-	attackResults[attacks] = p;
-	attacks++;
-
-	if (shotHit && !shipDestroyed && inStateOne)
-	{
-		inStateOne = false;
-		currentPoint = p;
-		hitResults[hits] = p;
-		hits++;
-	}
-
-	else if (shotHit && !shipDestroyed && !inStateOne)
-	{
-		limit++;
-		hitResults[hits] = p;
-		hits++;
-	}
-
-	else if (shotHit && shipDestroyed)
-	{
-		hitResults[hits] = p;
-		hits++;
-		inStateOne = true;
-		lastAction = false;
-		limit = 1;
-	}
-
-	return;
-}
-
-//This function does nothing
-
-void GoodPlayer::recordAttackByOpponent(Point p)
-{
-
-}
-
-
-
-//*********************************************************************
-//  createPlayer
-//*********************************************************************
-
-Player* createPlayer(string type, string nm, const Game& g)
-{
-	static string types[] = {
-		"human", "awful", "mediocre", "good"
-	};
-
-	int pos;
-	for (pos = 0; pos != sizeof(types) / sizeof(types[0]) &&
-		type != types[pos]; pos++)
-		;
-	switch (pos)
-	{
-	case 0:  return new HumanPlayer(nm, g);
-	case 1:  return new AwfulPlayer(nm, g);
-	case 2:  return new MediocrePlayer(nm, g);
-	case 3:  return new GoodPlayer(nm, g);
-	default: return nullptr;
-	}
-}
+#include "Player.h"
+#include "Board.h"
+#include "Game.h"
+#include "globals.h"
+#include "CellSet.h"
+#include "ShotHistory.h"
+#include "PlacementSolver.h"
+#include "PlacementTable.h"
+#include "Bitboard.h"
+#include "DensityMap.h"
+#include "FleetSampler.h"
+#include "EndgameSolver.h"
+#include "TranspositionTable.h"
+#include "OpeningBook.h"
+#include "Counters.h"
+#include <iostream>
+#include <string>
+#include <chrono>
+#include <vector>
+#include <memory>
+#include <thread>
+#include <algorithm>
+
+using namespace std;
+
+//*********************************************************************
+//  Timer Code
+//*********************************************************************
+
+//========================================================================
+// Timer t;                 // create a timer and start it
+// t.start();               // start the timer
+// double d = t.elapsed();  // milliseconds since timer was last started
+//========================================================================
+
+class Timer
+{
+public:
+	Timer()
+	{
+		start();
+	}
+	void start()
+	{
+		m_time = std::chrono::high_resolution_clock::now();
+	}
+	double elapsed() const
+	{
+		std::chrono::duration<double, std::milli> diff =
+			std::chrono::high_resolution_clock::now() - m_time;
+		return diff.count();
+	}
+private:
+	std::chrono::high_resolution_clock::time_point m_time;
+};
+
+//*********************************************************************
+//  AwfulPlayer
+//*********************************************************************
+
+class AwfulPlayer : public Player
+{
+public:
+	AwfulPlayer(string nm, const Game& g);
+	virtual bool placeShips(Board& b);
+	virtual Point recommendAttack();
+	virtual void recordAttackResult(Point p, bool validShot, bool shotHit,
+		bool shipDestroyed, int shipId);
+	virtual void recordAttackByOpponent(Point p);
+private:
+	Point m_lastCellAttacked;
+};
+
+AwfulPlayer::AwfulPlayer(string nm, const Game& g)
+	: Player(nm, g), m_lastCellAttacked(0, 0)
+{}
+
+bool AwfulPlayer::placeShips(Board& b)
+{
+	// Clustering ships is bad strategy
+	for (int k = 0; k < game().nShips(); k++)
+		if (!b.placeShip(Point(k, 0), k, HORIZONTAL))
+			return false;
+	return true;
+}
+
+Point AwfulPlayer::recommendAttack()
+{
+	if (m_lastCellAttacked.c > 0)
+		m_lastCellAttacked.c--;
+	else
+	{
+		m_lastCellAttacked.c = game().cols() - 1;
+		if (m_lastCellAttacked.r > 0)
+			m_lastCellAttacked.r--;
+		else
+			m_lastCellAttacked.r = game().rows() - 1;
+	}
+	return m_lastCellAttacked;
+}
+
+void AwfulPlayer::recordAttackResult(Point /* p */, bool /* validShot */,
+	bool /* shotHit */, bool /* shipDestroyed */,
+	int /* shipId */)
+{
+	// AwfulPlayer completely ignores the result of any attack
+}
+
+void AwfulPlayer::recordAttackByOpponent(Point /* p */)
+{
+	// AwfulPlayer completely ignores what the opponent does
+}
+
+//*********************************************************************
+//  HumanPlayer
+//*********************************************************************
+
+bool getLineWithTwoIntegers(int& r, int& c)
+{
+	bool result(cin >> r >> c);
+	if (!result)
+		cin.clear();  // clear error state so can do more input operations
+	cin.ignore(10000, '\n');
+	return result;
+}
+
+class HumanPlayer : public Player
+{
+public:
+	HumanPlayer(string nm, const Game& g);
+	virtual ~HumanPlayer() {}
+
+	virtual bool isHuman() const { return true; }
+
+	virtual bool placeShips(Board& b);
+	virtual Point recommendAttack();
+	virtual void recordAttackResult(Point p, bool validShot, bool shotHit,
+		bool shipDestroyed, int shipId) {}
+	virtual void recordAttackByOpponent(Point p) {}
+
+};
+
+HumanPlayer::HumanPlayer(string nm, const Game& g)
+	:Player(nm, g)
+{}
+
+bool HumanPlayer::placeShips(Board& b)
+{
+	cout << this->name() << " must place 5 ships." << endl;
+	b.clear();
+	b.display(false);
+	bool badInput = false;
+
+	for (int k = 0; k < 5; k++)
+	{
+		string output;
+
+		switch (k)
+		{
+		case 0:
+			output = "aircraft carrier (length 5):";
+			break;
+		case 1:
+			output = "battleship (length 4):";
+			break;
+		case 2:
+			output = "destroyer (length 3):";
+			break;
+		case 3:
+			output = "submarine (length 3):";
+			break;
+		case 4:
+			output = "patrol ship (length 2):";
+			break;
+		}
+
+		while (true)
+		{
+			if (k != 0 && !badInput)
+				cin.ignore(100000000, '\n');
+
+			badInput = false;
+
+			string input;
+			int row, col;
+			cout << "Enter h or v for direction of " << output;
+			getline(cin, input);
+
+			if (input[0] == 'h')
+			{
+				while (true)
+				{
+					cout << "Enter row and column of leftmost cell (e.g. 3 5):";
+					cin >> row >> col;
+					if (cin.fail())
+					{
+						cin.clear();
+						cin.ignore();
+						cout << "You must input two integers." << endl;
+						continue;
+					}
+
+					Point p(row, col);
+					if (!b.placeShip(p, k, HORIZONTAL))
+					{
+						cout << "The ship cannot be placed there" << endl;
+						continue;
+					}
+					break;
+				}
+				break;
+			}
+
+			else if (input[0] == 'v')
+			{
+				while (true)
+				{
+					cout << "Enter row and column of topmost cell (e.g. 3 5):";
+					cin >> row >> col;
+					if (cin.fail())
+					{
+						cin.clear();
+						cin.ignore();
+						cout << "You must input two integers." << endl;
+						continue;
+					}
+					Point p(row, col);
+					if (!b.placeShip(p, k, VERTICAL))
+					{
+						cout << "The ship cannot be placed there" << endl;
+						badInput = true;
+						continue;
+					}
+
+					break;
+				}
+				break;
+			}
+
+			else
+			{
+				cout << "Direction must be h or v." << endl;
+				continue;
+			}
+		}
+
+		if (k != 4)
+			b.display(false);
+	}
+
+	cin.ignore();
+
+	return true;
+}
+
+Point HumanPlayer::recommendAttack()
+{
+
+	int row, col;
+
+	while (true)
+	{
+		cout << "Enter the row and column to attack (e.g, 3 5):";
+		cin >> row >> col;
+		if (cin.fail())
+		{
+			cin.clear();
+			cin.ignore();
+			cout << "You must input two integers." << endl;
+			continue;
+		}
+
+		Point p(row, col);
+
+		return p;
+	}
+
+	Point p(0, 0);
+
+	return p;
+}
+
+//*********************************************************************
+//  MediocrePlayer
+//*********************************************************************
+
+class MediocrePlayer : public Player
+{
+public:
+	MediocrePlayer(string nm, const Game& g);
+	virtual ~MediocrePlayer() {}
+
+	virtual bool isHuman() const { return false; }
+	virtual bool placeShips(Board& b);
+	virtual Point recommendAttack();
+	virtual void recordAttackResult(Point p, bool validShot, bool shotHit,
+		bool shipDestroyed, int shipId);
+	virtual void recordAttackByOpponent(Point p) {}
+
+private:
+	bool didFire(const Point& p) const;
+	int targetCells(int cells[]) const;
+	bool placeAtRandom(Board& b);
+	bool inStateOne;
+
+	Point currentPoint;
+
+	ShotHistory m_shots;
+	CellSet m_unfired;
+};
+
+MediocrePlayer::MediocrePlayer(string nm, const Game& g)
+	:Player(nm, g), inStateOne(true), m_shots(g),
+	m_unfired(g.rows() * g.cols())
+{
+	for (int k = 0; k < g.rows() * g.cols(); k++)
+		m_unfired.insert(k);
+}
+
+///////////////////////////////////////////
+//              Helper Functions
+///////////////////////////////////////////
+
+//	This function collects the cells that have not been fired
+//	upon and are within 4 cells of the point that was first hit,
+//	in the same row or column. There are at most 16 of them.
+
+int MediocrePlayer::targetCells(int cells[]) const
+{
+	const int dr[4] = { 0, 0, 1, -1 };
+	const int dc[4] = { 1, -1, 0, 0 };
+	int n = 0;
+
+	for (int d = 0; d < 4; d++)
+	{
+		for (int k = 1; k <= 4; k++)
+		{
+			Point p(currentPoint.r + k * dr[d], currentPoint.c + k * dc[d]);
+			if (game().isValid(p) && !didFire(p))
+				cells[n++] = p.r * game().cols() + p.c;
+		}
+	}
+
+	return n;
+}
+
+//	This helper function determines whether the give point has been fired or not
+
+bool MediocrePlayer::didFire(const Point& p) const
+{
+	return m_shots.fired(p);
+}
+
+///////////////////////////////////////////
+//     Public Interface Implementation
+///////////////////////////////////////////
+
+//	Block half of the cells at random and solve for a placement
+//	that avoids them, trying again with a fresh set of blocked
+//	cells whenever none exists.
+
+bool MediocrePlayer::placeShips(Board& b)
+{
+	if (!PlacementTable::fits(game().rows(), game().cols()))
+		return placeAtRandom(b);
+
+	const int nCells = game().rows() * game().cols();
+	vector<ShipPlacement> placements;
+
+	for (int k = 0; k < 50; k++)
+	{
+		BATTLESHIP_COUNT(game(), blockRounds, 1);
+		Bitboard blocked = Bitboard::random(nCells, game().rng());
+
+		if (solvePlacement(game(), blocked, placements))
+		{
+			for (int s = 0; s < game().nShips(); s++)
+				if (!b.placeShip(placements[s].topOrLeft, s, placements[s].dir))
+					return false;
+			return true;
+		}
+	}
+
+	return false;
+}
+
+//	Boards too large for the solver are sparsely filled, so
+//	ships are simply dropped at random positions, starting over
+//	if some ship cannot be fitted in.
+
+bool MediocrePlayer::placeAtRandom(Board& b)
+{
+	const int nShips = game().nShips();
+	const int tries = 1000;
+
+	for (int k = 0; k < 50; k++)
+	{
+		vector<ShipPlacement> placed;
+
+		for (int s = 0; s < nShips; s++)
+		{
+			for (int t = 0; t < tries; t++)
+			{
+				BATTLESHIP_COUNT(game(), placementTries, 1);
+				ShipPlacement sp(game().randomPoint(),
+					game().rng().randInt(2) == 0 ? HORIZONTAL : VERTICAL);
+				if (b.placeShip(sp.topOrLeft, s, sp.dir))
+				{
+					placed.push_back(sp);
+					break;
+				}
+			}
+			if (static_cast<int>(placed.size()) != s + 1)
+				break;
+		}
+
+		if (static_cast<int>(placed.size()) == nShips)
+			return true;
+
+		for (size_t s = 0; s < placed.size(); s++)
+			b.unplaceShip(placed[s].topOrLeft, static_cast<int>(s), placed[s].dir);
+	}
+
+	return false;
+}
+
+//	Targets are drawn straight from the candidate cells, so a
+//	move never depends on how full the board is. If nothing is
+//	left around the hit, go back to state 1.
+
+Point MediocrePlayer::recommendAttack()
+{
+	const int cols = game().cols();
+	BATTLESHIP_COUNT(game(), attackCalls, 1);
+
+	if (!inStateOne)
+	{
+		int cells[16];
+		const int n = targetCells(cells);
+		if (n > 0)
+		{
+			BATTLESHIP_COUNT(game(), candidateDraws, 1);
+			const int cell = cells[game().rng().randInt(n)];
+			return Point(cell / cols, cell % cols);
+		}
+		inStateOne = true;
+	}
+
+	if (m_unfired.empty())
+		return Point(0, 0);
+
+	BATTLESHIP_COUNT(game(), candidateDraws, 1);
+	const int cell = m_unfired.sample(game().rng());
+	return Point(cell / cols, cell % cols);
+}
+
+void MediocrePlayer::recordAttackResult(Point p, bool validShot, bool shotHit,
+	bool shipDestroyed, int shipId)
+{
+	if (!validShot)
+		return;
+
+	m_shots.record(p, shotHit);
+	m_unfired.erase(p.r * game().cols() + p.c);
+
+	if (shotHit && !shipDestroyed && inStateOne)
+	{
+		inStateOne = false;
+		currentPoint = p;
+	}
+
+	else if (shotHit && shipDestroyed)
+		inStateOne = true;
+
+	return;
+}
+
+//*********************************************************************
+//  GoodPlayer
+//*********************************************************************
+
+class GoodPlayer : public Player
+{
+public:
+	GoodPlayer(string nm, const Game& g);
+	virtual ~GoodPlayer() {}
+
+	virtual bool isHuman() const { return false; }
+	virtual bool placeShips(Board& b);
+	virtual Point recommendAttack();
+	virtual void recordAttackResult(Point p, bool validShot, bool shotHit,
+		bool shipDestroyed, int shipId);
+	virtual void recordAttackByOpponent(Point p);
+
+private:
+	ShotHistory m_shots;
+	Point currentPoint;
+
+	int limit;
+
+	bool inStateOne;
+	bool lastAction;
+	bool escape;
+
+	//Cells that have not been fired upon, grouped by the
+	//rule that allows them to be picked while hunting
+
+	CellSet m_huntCells;     // parity cells and cells beyond two hits in a row
+	CellSet m_escapeCells;   // parity cells and cells next to any hit
+	CellSet m_unfired;
+
+	//Only kept when the board fits in a PlacementTable
+
+	unique_ptr<EndgameSolver> m_endgame;
+
+	bool didFire(const Point& p) const;
+	bool didHit(const Point& p) const;
+	bool isUnique(const Point& p) const;
+	bool isHorizontal() const;
+	bool isVertical() const;
+	int cellOf(const Point& p) const { return p.r * game().cols() + p.c; }
+	Point pick(const CellSet& cells) const;
+	Point pick(const int cells[], int n) const;
+	int rayCells(Direction dir, int cells[]) const;
+	void addCandidate(CellSet& cells, const Point& p);
+	void noteHit(const Point& p);
+};
+
+GoodPlayer::GoodPlayer(string nm, const Game& g)
+	:Player(nm, g), m_shots(g), limit(1),
+	inStateOne(true), lastAction(false), escape(false),
+	m_huntCells(g.rows() * g.cols()), m_escapeCells(g.rows() * g.cols()),
+	m_unfired(g.rows() * g.cols())
+{
+	if (PlacementTable::fits(g.rows(), g.cols()))
+		m_endgame.reset(new EndgameSolver(g));
+
+	for (int r = 0; r < g.rows(); r++)
+	{
+		for (int c = 0; c < g.cols(); c++)
+		{
+			Point p(r, c);
+			m_unfired.insert(cellOf(p));
+			if (isUnique(p))
+			{
+				m_huntCells.insert(cellOf(p));
+				m_escapeCells.insert(cellOf(p));
+			}
+		}
+	}
+}
+
+///////////////////////////////////////////
+//              Helper Functions
+///////////////////////////////////////////
+
+//This helper function determines whether a point
+//has been fired or not
+
+bool GoodPlayer::didFire(const Point& p) const
+{
+	return m_shots.fired(p);
+}
+
+//This helper function determines whether a ship
+//has been hit in the point or not
+
+bool GoodPlayer::didHit(const Point& p) const
+{
+	return m_shots.hit(p);
+}
+
+//This helper function determines whether a point's
+//coordinates are both odd or both even. This is a 
+//useful standard in attacking under state 1. However
+//there are special cases involved. Following two helper
+//functions help dignose those special cases
+
+bool GoodPlayer::isUnique(const Point& p) const
+{
+	const int row = p.r;
+	const int col = p.c;
+
+	if (row % 2 != 0)
+	{
+		if (col % 2 != 0)
+			return true;
+	}
+
+	else
+	{
+		if (col % 2 == 0)
+			return true;
+	}
+
+	return false;
+}
+
+//Cells become hunting candidates as hits land: any cell
+//next to a hit is a candidate once the 120-trial escape has
+//happened, and a cell beyond two hits in a row always is.
+
+void GoodPlayer::addCandidate(CellSet& cells, const Point& p)
+{
+	if (game().isValid(p) && !didFire(p))
+		cells.insert(cellOf(p));
+}
+
+void GoodPlayer::noteHit(const Point& p)
+{
+	const int dr[4] = { 0, 0, 1, -1 };
+	const int dc[4] = { 1, -1, 0, 0 };
+
+	for (int d = 0; d < 4; d++)
+	{
+		Point next(p.r + dr[d], p.c + dc[d]);
+		Point next2(p.r + 2 * dr[d], p.c + 2 * dc[d]);
+
+		addCandidate(m_escapeCells, next);
+
+		if (m_shots.beyondTwoHits(next))
+			addCandidate(m_huntCells, next);
+		if (didHit(next) && m_shots.beyondTwoHits(next2))
+			addCandidate(m_huntCells, next2);
+	}
+}
+
+//This function collects the cells that have not been fired
+//upon and are within the range away from the first hit point,
+//in the given direction.
+
+int GoodPlayer::rayCells(Direction dir, int cells[]) const
+{
+	const int range = limit > 4 ? 4 : limit;
+	int n = 0;
+
+	for (int k = -range; k <= range; k++)
+	{
+		Point p = (dir == HORIZONTAL ? Point(currentPoint.r, currentPoint.c + k)
+			: Point(currentPoint.r + k, currentPoint.c));
+		if (k != 0 && game().isValid(p) && !didFire(p))
+			cells[n++] = cellOf(p);
+	}
+
+	return n;
+}
+
+Point GoodPlayer::pick(const CellSet& cells) const
+{
+	BATTLESHIP_COUNT(game(), candidateDraws, 1);
+	const int cell = cells.sample(game().rng());
+	return Point(cell / game().cols(), cell % game().cols());
+}
+
+Point GoodPlayer::pick(const int cells[], int n) const
+{
+	BATTLESHIP_COUNT(game(), candidateDraws, 1);
+	const int cell = cells[game().rng().randInt(n)];
+	return Point(cell / game().cols(), cell % game().cols());
+}
+
+//This helper function checks if the opponent's
+//ship is placed horizontally.
+
+bool GoodPlayer::isHorizontal() const
+{
+	return (m_shots.hitNeighbours(currentPoint) &
+		(ShotHistory::LEFT | ShotHistory::RIGHT)) != 0;
+}
+
+//This helper function checks if the opponent's
+//ship is placed vertically.
+
+bool GoodPlayer::isVertical() const
+{
+	return (m_shots.hitNeighbours(currentPoint) &
+		(ShotHistory::UP | ShotHistory::DOWN)) != 0;
+}
+
+///////////////////////////////////////////
+//    Public Interface Implementation
+///////////////////////////////////////////
+
+bool GoodPlayer::placeShips(Board& b)
+{
+	const int nShips = game().nShips();
+
+	for (int k = 0; k < nShips; k++)
+	{
+		while (true)
+		{
+			BATTLESHIP_COUNT(game(), placementTries, 1);
+			Point p = game().randomPoint();
+			const int a = game().rng().randInt(2);
+
+			//Let the directin of placement to 
+			//be determined by randomness
+
+			if (a == 0)
+			{
+				if (b.placeShip(p, k, HORIZONTAL))
+					break;
+				else
+					continue;
+			}
+
+			else
+			{
+				if (b.placeShip(p, k, VERTICAL))
+					break;
+				else
+					continue;
+			}
+		}
+	}
+
+	return true;
+}
+
+//Every choice is drawn directly from the cells that qualify,
+//so a move never needs more than one random draw. When no cell
+//qualifies, the next looser rule is tried instead. Once few
+//enough fleets agree with the shots, the endgame solver picks
+//the cell instead.
+
+Point GoodPlayer::recommendAttack()
+{
+	BATTLESHIP_COUNT(game(), attackCalls, 1);
+
+	if (m_endgame && m_endgame->solve())
+	{
+		const int cell = m_endgame->bestCell(game().rng());
+		if (cell >= 0)
+			return Point(cell / game().cols(), cell % game().cols());
+	}
+
+	if (!inStateOne)
+	{
+		int cells[16];
+		int n;
+
+		if (!lastAction)
+		{
+			if (isHorizontal())
+			{
+				n = rayCells(HORIZONTAL, cells);
+				if (n > 0)
+					return pick(cells, n);
+				lastAction = true;
+			}
+
+			if (isVertical())
+			{
+				n = rayCells(VERTICAL, cells);
+				if (n > 0)
+					return pick(cells, n);
+				lastAction = true;
+			}
+		}
+
+		//Widen the range around the first hit until some
+		//cell qualifies
+
+		while (true)
+		{
+			n = rayCells(HORIZONTAL, cells);
+			n += rayCells(VERTICAL, cells + n);
+			if (n > 0)
+				return pick(cells, n);
+			if (limit >= 4)
+				break;
+			limit++;
+			BATTLESHIP_COUNT(game(), rangeWidenings, 1);
+		}
+	}
+
+	//The special cases only matter once no parity cell is left
+
+	if (!escape && m_huntCells.empty())
+	{
+		escape = true;
+		BATTLESHIP_COUNT(game(), escapes, 1);
+	}
+
+	if (!escape)
+		return pick(m_huntCells);
+	if (!m_escapeCells.empty())
+		return pick(m_escapeCells);
+	if (!m_unfired.empty())
+	{
+		BATTLESHIP_COUNT(game(), unfiredFallbacks, 1);
+		return pick(m_unfired);
+	}
+
+	return Point(0, 0);
+}
+
+void GoodPlayer::recordAttackResult(Point p, bool validShot, bool shotHit,
+	bool shipDestroyed, int shipId)
+{
+	if (!validShot)
+		return;
+
+	m_shots.record(p, shotHit);
+
+	if (m_endgame)
+		m_endgame->record(cellOf(p), shotHit, shipDestroyed ? shipId : -1);
+
+	m_huntCells.erase(cellOf(p));
+	m_escapeCells.erase(cellOf(p));
+	m_unfired.erase(cellOf(p));
+
+	if (shotHit)
+		noteHit(p);
+
+	if (shotHit && !shipDestroyed && inStateOne)
+	{
+		inStateOne = false;
+		currentPoint = p;
+	}
+
+	else if (shotHit && !shipDestroyed && !inStateOne)
+		limit++;
+
+	else if (shotHit && shipDestroyed)
+	{
+		inStateOne = true;
+		lastAction = false;
+		limit = 1;
+	}
+
+	return;
+}
+
+//This function does nothing
+
+void GoodPlayer::recordAttackByOpponent(Point p)
+{
+
+}
+
+//*********************************************************************
+//  DensityPlayer
+//*********************************************************************
+
+//A DensityPlayer fires at the cell covered by the most ship
+//placements that are still possible, or late in the game at
+//the cell covered by the most whole fleets. It plays from the
+//opening book while there is one and the game stays in it. It
+//needs a PlacementTable, so createPlayer hands out a GoodPlayer
+//for larger boards.
+
+class DensityPlayer : public Player
+{
+public:
+	DensityPlayer(string nm, const Game& g)
+		: Player(nm, g), m_table(PlacementTable::forGame(g)), m_map(g),
+		m_endgame(g), m_book(g)
+	{}
+	virtual ~DensityPlayer() {}
+
+	virtual bool isHuman() const { return false; }
+	virtual bool placeShips(Board& b);
+	virtual Point recommendAttack();
+	virtual void recordAttackResult(Point p, bool validShot, bool shotHit,
+		bool shipDestroyed, int shipId);
+	virtual void recordAttackByOpponent(Point p) {}
+
+private:
+	shared_ptr<const PlacementTable> m_table;
+	DensityMap m_map;
+	EndgameSolver m_endgame;
+	BookLine m_book;
+};
+
+//Each ship gets a uniformly random placement that misses the
+//ships already placed, starting over if some ship is stuck.
+
+static bool placeFromTable(const Game& g, const PlacementTable& table, Board& b)
+{
+	const int nShips = g.nShips();
+
+	for (int k = 0; k < 50; k++)
+	{
+		Bitboard used;
+		vector<int> placed;
+
+		for (int s = 0; s < nShips; s++)
+		{
+			for (int t = 0; t < 1000; t++)
+			{
+				BATTLESHIP_COUNT(g, placementTries, 1);
+				const int j = g.rng().randInt(table.count(s));
+				if (!table.mask(s, j).intersects(used))
+				{
+					used |= table.mask(s, j);
+					placed.push_back(j);
+					break;
+				}
+			}
+			if (static_cast<int>(placed.size()) != s + 1)
+				break;
+		}
+
+		if (static_cast<int>(placed.size()) == nShips)
+		{
+			for (int s = 0; s < nShips; s++)
+			{
+				ShipPlacement sp = table.placement(s, placed[s]);
+				if (!b.placeShip(sp.topOrLeft, s, sp.dir))
+					return false;
+			}
+			return true;
+		}
+	}
+
+	return false;
+}
+
+bool DensityPlayer::placeShips(Board& b)
+{
+	return placeFromTable(game(), *m_table, b);
+}
+
+Point DensityPlayer::recommendAttack()
+{
+	BATTLESHIP_COUNT(game(), attackCalls, 1);
+
+	int cell = m_book.move();
+	if (cell < 0 && m_endgame.solve())
+		cell = m_endgame.bestCell(game().rng());
+	if (cell < 0)
+		cell = m_map.bestCell(game().rng());
+	if (cell < 0)
+		return Point(0, 0);
+	return Point(cell / game().cols(), cell % game().cols());
+}
+
+void DensityPlayer::recordAttackResult(Point p, bool validShot, bool shotHit,
+	bool shipDestroyed, int shipId)
+{
+	if (!validShot)
+		return;
+
+	const int cell = p.r * game().cols() + p.c;
+
+	if (!shotHit)
+		m_map.recordMiss(cell);
+	else
+	{
+		m_map.recordHit(cell);
+		if (shipDestroyed)
+			m_map.recordSink(cell, shipId);
+	}
+	m_endgame.record(cell, shotHit, shipDestroyed ? shipId : -1);
+	m_book.record(cell, shotHit, shipDestroyed ? shipId : -1);
+}
+
+
+
+//*********************************************************************
+//  MonteCarloPlayer
+//*********************************************************************
+
+//A MonteCarloPlayer spends a fixed time on each move drawing
+//fleets that agree with its shots, sharing the drawing among
+//a number of threads, and fires at the unfired cell the most
+//fleets cover. Since the number of fleets drawn depends on the
+//clock, its games cannot be replayed from a seed.
+//
+//Every move it works out goes into the process's shared
+//transposition table, keyed by the shot state, so a state that
+//comes up again, in this game or any other, costs a lookup.
+//Moves in the opening book cost a lookup from the start.
+
+const int MONTECARLO_THREADS = 1;
+const double MONTECARLO_MS_PER_MOVE = 1.0;
+const uint64_t MONTECARLO_SALT = 0x6d6f6e746563ULL;
+
+class MonteCarloPlayer : public Player
+{
+public:
+	MonteCarloPlayer(string nm, const Game& g, int nThreads, double msPerMove);
+	virtual ~MonteCarloPlayer() {}
+
+	virtual bool isHuman() const { return false; }
+	virtual bool placeShips(Board& b);
+	virtual Point recommendAttack();
+	virtual void recordAttackResult(Point p, bool validShot, bool shotHit,
+		bool shipDestroyed, int shipId);
+	virtual void recordAttackByOpponent(Point p) {}
+
+private:
+	struct Tally
+	{
+		vector<int> counts;   // fleets covering each cell
+		long long samples;
+		long long rejected;
+	};
+
+	void sample(const FleetSampler& sampler, const Timer& timer, uint64_t seed,
+		Tally& tally) const;
+
+	shared_ptr<const PlacementTable> m_table;
+	DensityMap m_map;
+	EndgameSolver m_endgame;
+	ShotKey m_key;
+	TranspositionTable& m_known;
+	BookLine m_book;
+	vector<bool> m_afloat;
+	Bitboard m_fired;
+	int m_nThreads;
+	double m_msPerMove;
+};
+
+MonteCarloPlayer::MonteCarloPlayer(string nm, const Game& g, int nThreads,
+	double msPerMove)
+	: Player(nm, g), m_table(PlacementTable::forGame(g)), m_map(g),
+	m_endgame(g), m_key(g, MONTECARLO_SALT), m_known(TranspositionTable::shared()),
+	m_book(g), m_afloat(g.nShips(), true), m_nThreads(nThreads > 0 ? nThreads : 1),
+	m_msPerMove(msPerMove)
+{}
+
+bool MonteCarloPlayer::placeShips(Board& b)
+{
+	return placeFromTable(game(), *m_table, b);
+}
+
+//The clock is only read every few fleets, as reading it costs
+//about as much as drawing one
+
+void MonteCarloPlayer::sample(const FleetSampler& sampler, const Timer& timer,
+	uint64_t seed, Tally& tally) const
+{
+	Rng rng;
+	rng.seed(seed);
+	tally.counts.assign(game().rows() * game().cols(), 0);
+	tally.samples = 0;
+	tally.rejected = 0;
+
+	Bitboard ships;
+
+	while (tally.samples % 16 != 0 || timer.elapsed() < m_msPerMove)
+	{
+		tally.samples++;
+		if (!sampler.sample(rng, ships))
+		{
+			tally.rejected++;
+			continue;
+		}
+		ships.andNot(m_fired);
+		forEachCell(ships, [&](int cell) { tally.counts[cell]++; });
+	}
+}
+
+//Once the fleets can be listed there is nothing left to draw.
+//Whenever no fleet could be drawn, fall back on the density
+//of single placements.
+
+Point MonteCarloPlayer::recommendAttack()
+{
+	BATTLESHIP_COUNT(game(), attackCalls, 1);
+
+	const int opening = m_book.move();
+	if (opening >= 0)
+		return Point(opening / game().cols(), opening % game().cols());
+
+	if (m_endgame.solve())
+	{
+		const int cell = m_endgame.bestCell(game().rng());
+		if (cell >= 0)
+			return Point(cell / game().cols(), cell % game().cols());
+	}
+
+	const int cols = game().cols();
+	const int nCells = game().rows() * cols;
+
+	//A move from the table is checked, in case two states
+	//share a key
+
+	int known;
+	uint32_t quality;
+	BATTLESHIP_COUNT(game(), tableProbes, 1);
+	if (m_known.probe(m_key.key(), known, quality) &&
+		known >= 0 && known < nCells && !m_fired.test(known))
+	{
+		BATTLESHIP_COUNT(game(), tableHits, 1);
+		return Point(known / cols, known % cols);
+	}
+
+	Timer timer;
+	FleetSampler sampler(m_table, m_map, m_afloat);
+
+	vector<Tally> tallies(m_nThreads);
+	int best = -1;
+
+	if (sampler.possible())
+	{
+		vector<uint64_t> seeds(m_nThreads);
+		for (int t = 0; t < m_nThreads; t++)
+			seeds[t] = game().rng().next();
+
+		vector<thread> helpers;
+		for (int t = 1; t < m_nThreads; t++)
+			helpers.push_back(thread(&MonteCarloPlayer::sample, this, cref(sampler),
+				cref(timer), seeds[t], ref(tallies[t])));
+		sample(sampler, timer, seeds[0], tallies[0]);
+		for (size_t t = 0; t < helpers.size(); t++)
+			helpers[t].join();
+
+		for (int t = 1; t < m_nThreads; t++)
+		{
+			for (int cell = 0; cell < nCells; cell++)
+				tallies[0].counts[cell] += tallies[t].counts[cell];
+			tallies[0].samples += tallies[t].samples;
+			tallies[0].rejected += tallies[t].rejected;
+		}
+		BATTLESHIP_COUNT(game(), fleetSamples, tallies[0].samples);
+		BATTLESHIP_COUNT(game(), rejectedSamples, tallies[0].rejected);
+
+		//Ties are broken at random
+
+		const vector<int>& counts = tallies[0].counts;
+		int ties = 0;
+		for (int cell = 0; cell < nCells; cell++)
+		{
+			if (m_fired.test(cell) || counts[cell] == 0)
+				continue;
+			if (best < 0 || counts[cell] > counts[best])
+			{
+				best = cell;
+				ties = 1;
+			}
+			else if (counts[cell] == counts[best] && game().rng().randInt(++ties) == 0)
+				best = cell;
+		}
+
+		if (best >= 0)
+		{
+			const long long drawn = tallies[0].samples - tallies[0].rejected;
+			m_known.store(m_key.key(), best,
+				static_cast<uint32_t>(min(drawn, 0xffffffffLL)));
+		}
+	}
+
+	if (best < 0)
+		best = m_map.bestCell(game().rng());
+	if (best < 0)
+		return Point(0, 0);
+	return Point(best / cols, best % cols);
+}
+
+void MonteCarloPlayer::recordAttackResult(Point p, bool validShot, bool shotHit,
+	bool shipDestroyed, int shipId)
+{
+	if (!validShot)
+		return;
+
+	const int cell = p.r * game().cols() + p.c;
+	m_fired.set(cell);
+
+	if (!shotHit)
+	{
+		m_map.recordMiss(cell);
+		m_key.recordMiss(cell);
+	}
+	else
+	{
+		m_map.recordHit(cell);
+		m_key.recordHit(cell);
+		if (shipDestroyed)
+		{
+			m_map.recordSink(cell, shipId);
+			m_key.recordSink(cell, shipId);
+			m_afloat[shipId] = false;
+		}
+	}
+	m_endgame.record(cell, shotHit, shipDestroyed ? shipId : -1);
+	m_book.record(cell, shotHit, shipDestroyed ? shipId : -1);
+}
+
+//*********************************************************************
+//  createPlayer
+//*********************************************************************
+
+Player* createPlayer(string type, string nm, const Game& g)
+{
+	static string types[] = {
+		"human", "awful", "mediocre", "good", "density", "montecarlo"
+	};
+
+	int pos;
+	for (pos = 0; pos != sizeof(types) / sizeof(types[0]) &&
+		type != types[pos]; pos++)
+		;
+	switch (pos)
+	{
+	case 0:  return new HumanPlayer(nm, g);
+	case 1:  return new AwfulPlayer(nm, g);
+	case 2:  return new MediocrePlayer(nm, g);
+	case 3:  return new GoodPlayer(nm, g);
+	case 4:
+		if (PlacementTable::fits(g.rows(), g.cols()))
+			return new DensityPlayer(nm, g);
+		return new GoodPlayer(nm, g);
+	case 5:
+		return createMonteCarloPlayer(nm, g, MONTECARLO_THREADS,
+			MONTECARLO_MS_PER_MOVE);
+	default: return nullptr;
+	}
+}
+
+//Like the density player, a MonteCarloPlayer needs a
+//PlacementTable, so larger boards get a GoodPlayer instead
+
+Player* createMonteCarloPlayer(string nm, const Game& g, int nThreads,
+	double msPerMove)
+{
+	if (!PlacementTable::fits(g.rows(), g.cols()))
+		return new GoodPlayer(nm, g);
+	return new MonteCarloPlayer(nm, g, nThreads, msPerMove);
+}
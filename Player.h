@@ -37,4 +37,9 @@ private:
 
 Player* createPlayer(std::string type, std::string nm, const Game& g);
 
+  // A "montecarlo" player that samples with nThreads threads for about
+  // msPerMove milliseconds before each move
+Player* createMonteCarloPlayer(std::string nm, const Game& g, int nThreads,
+                               double msPerMove);
+
 #endif // PLAYER_INCLUDED
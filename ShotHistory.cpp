@@ -0,0 +1,59 @@
+#include "ShotHistory.h"
+#include "Game.h"
+
+using namespace std;
+
+ShotHistory::ShotHistory(const Game& g)
+ : m_stride(g.cols() + 2 * MARGIN), m_nShots(0), m_nHits(0)
+{
+	const int nBits = (g.rows() + 2 * MARGIN) * m_stride;
+	m_fired.assign((nBits + 63) / 64, 0);
+	m_hit.assign((nBits + 63) / 64, 0);
+}
+
+//Only the first shot at a cell counts
+
+void ShotHistory::record(Point p, bool shotHit)
+{
+	const int b = bitOf(p);
+	if (testBit(m_fired, b))
+		return;
+
+	setBit(m_fired, b);
+	m_nShots++;
+
+	if (shotHit)
+	{
+		setBit(m_hit, b);
+		m_nHits++;
+	}
+}
+
+int ShotHistory::hitNeighbours(Point p) const
+{
+	const int b = bitOf(p);
+	int dirs = 0;
+
+	if (testBit(m_hit, b + 1))
+		dirs |= RIGHT;
+	if (testBit(m_hit, b - 1))
+		dirs |= LEFT;
+	if (testBit(m_hit, b + m_stride))
+		dirs |= DOWN;
+	if (testBit(m_hit, b - m_stride))
+		dirs |= UP;
+
+	return dirs;
+}
+
+bool ShotHistory::beyondTwoHits(Point p) const
+{
+	const int b = bitOf(p);
+	const int step[4] = { 1, -1, m_stride, -m_stride };
+
+	for (int d = 0; d < 4; d++)
+		if (testBit(m_hit, b + step[d]) && testBit(m_hit, b + 2 * step[d]))
+			return true;
+
+	return false;
+}
@@ -0,0 +1,57 @@
+
+#ifndef SHOTHISTORY_INCLUDED
+#define SHOTHISTORY_INCLUDED
+
+#include "globals.h"
+#include <vector>
+#include <cstdint>
+
+class Game;
+
+// A ShotHistory records which cells a player has fired at and which of
+// those shots hit, as two bitsets sized to the game's board.  The bitsets
+// have a two-cell margin of never-fired cells all around the board, so a
+// query about a point up to two cells off the board needs no bounds check.
+
+class ShotHistory
+{
+public:
+    ShotHistory(const Game& g);
+
+      // Directions for hitNeighbours
+    enum { RIGHT = 1, LEFT = 2, DOWN = 4, UP = 8 };
+
+    void record(Point p, bool shotHit);
+    bool fired(Point p) const { return testBit(m_fired, bitOf(p)); }
+    bool hit(Point p) const { return testBit(m_hit, bitOf(p)); }
+    int nShots() const { return m_nShots; }
+    int nHits() const { return m_nHits; }
+
+      // The directions (RIGHT | LEFT | DOWN | UP) in which the cell next
+      // to p was hit
+    int hitNeighbours(Point p) const;
+
+      // True if the two cells beyond p in some direction were both hit
+    bool beyondTwoHits(Point p) const;
+
+private:
+    static const int MARGIN = 2;
+
+    int bitOf(Point p) const { return (p.r + MARGIN) * m_stride + p.c + MARGIN; }
+    static bool testBit(const std::vector<std::uint64_t>& bits, int b)
+    {
+        return (bits[b >> 6] >> (b & 63)) & 1;
+    }
+    static void setBit(std::vector<std::uint64_t>& bits, int b)
+    {
+        bits[b >> 6] |= std::uint64_t(1) << (b & 63);
+    }
+
+    int m_stride;
+    std::vector<std::uint64_t> m_fired;
+    std::vector<std::uint64_t> m_hit;
+    int m_nShots;
+    int m_nHits;
+};
+
+#endif // SHOTHISTORY_INCLUDED
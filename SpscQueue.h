@@ -0,0 +1,81 @@
+
+#ifndef SPSCQUEUE_INCLUDED
+#define SPSCQUEUE_INCLUDED
+
+#include <atomic>
+#include <cstddef>
+#include <memory>
+
+// A SpscQueue is a fixed-size ring buffer that one thread pushes to and
+// one other thread pops from, with no locks.  Each side keeps its own index
+// on its own cache line, along with its last look at the other side's
+// index, so the two threads only touch each other's line when the queue
+// seems full or empty.
+
+template <class T>
+class SpscQueue
+{
+public:
+      // The capacity is rounded up to a power of two
+    explicit SpscQueue(std::size_t capacity)
+     : m_mask(roundUp(capacity) - 1), m_slots(new T[m_mask + 1]),
+       m_tail(0), m_cachedHead(0), m_head(0), m_cachedTail(0)
+    {}
+
+      // Producer only.  False if the queue is full.
+    bool tryPush(const T& value)
+    {
+        const std::size_t tail = m_tail.load(std::memory_order_relaxed);
+        if (tail - m_cachedHead > m_mask)
+        {
+            m_cachedHead = m_head.load(std::memory_order_acquire);
+            if (tail - m_cachedHead > m_mask)
+                return false;
+        }
+        m_slots[tail & m_mask] = value;
+        m_tail.store(tail + 1, std::memory_order_release);
+        return true;
+    }
+
+      // Consumer only.  False if the queue is empty.
+    bool tryPop(T& value)
+    {
+        const std::size_t head = m_head.load(std::memory_order_relaxed);
+        if (head == m_cachedTail)
+        {
+            m_cachedTail = m_tail.load(std::memory_order_acquire);
+            if (head == m_cachedTail)
+                return false;
+        }
+        value = m_slots[head & m_mask];
+        m_head.store(head + 1, std::memory_order_release);
+        return true;
+    }
+
+    std::size_t capacity() const { return m_mask + 1; }
+
+    SpscQueue(const SpscQueue&) = delete;
+    SpscQueue& operator=(const SpscQueue&) = delete;
+
+private:
+    static std::size_t roundUp(std::size_t n)
+    {
+        std::size_t p = 1;
+        while (p < n)
+            p *= 2;
+        return p;
+    }
+
+    const std::size_t m_mask;
+    std::unique_ptr<T[]> m_slots;
+
+      // Written by the producer
+    alignas(64) std::atomic<std::size_t> m_tail;
+    std::size_t m_cachedHead;
+
+      // Written by the consumer
+    alignas(64) std::atomic<std::size_t> m_head;
+    std::size_t m_cachedTail;
+};
+
+#endif // SPSCQUEUE_INCLUDED
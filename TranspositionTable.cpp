@@ -0,0 +1,135 @@
+#include "TranspositionTable.h"
+#include "Game.h"
+
+using namespace std;
+
+//*********************************************************************
+//  ShotKey
+//*********************************************************************
+
+ShotKey::ShotKey(const Game& g, uint64_t salt)
+ : m_key(feature(BOARD, static_cast<uint64_t>(g.rows()) << 32 | g.cols()) ^
+	feature(SALT, salt))
+{
+	for (int s = 0; s < g.nShips(); s++)
+		m_key ^= feature(SHIP, static_cast<uint64_t>(s) << 32 | g.shipLength(s));
+}
+
+//*********************************************************************
+//  TranspositionTable
+//*********************************************************************
+
+TranspositionTable::TranspositionTable(size_t maxBytes)
+ : m_nBuckets(0), m_mask(0)
+{
+	resize(maxBytes);
+}
+
+TranspositionTable& TranspositionTable::shared()
+{
+	static TranspositionTable table(TRANSPOSITION_TABLE_BYTES);
+	return table;
+}
+
+//The number of buckets is a power of two, so a bucket is picked
+//by masking the key
+
+void TranspositionTable::resize(size_t maxBytes)
+{
+	size_t n = 1;
+	while (2 * n * sizeof(Bucket) <= maxBytes)
+		n *= 2;
+	if (n * sizeof(Bucket) > maxBytes)
+		n = 0;
+
+	m_buckets.reset(n > 0 ? new Bucket[n] : nullptr);
+	m_nBuckets = n;
+	m_mask = n > 0 ? n - 1 : 0;
+	clear();
+}
+
+void TranspositionTable::clear()
+{
+	for (size_t b = 0; b < m_nBuckets; b++)
+	{
+		for (int e = 0; e < BUCKET_ENTRIES; e++)
+		{
+			m_buckets[b].entries[e].check.store(0, memory_order_relaxed);
+			m_buckets[b].entries[e].data.store(0, memory_order_relaxed);
+		}
+	}
+}
+
+//An entry holds the state if its check matches; an empty entry
+//never does, as its data is 0
+
+static bool holds(uint64_t check, uint64_t data, uint64_t key)
+{
+	return data != 0 && (check ^ data) == key;
+}
+
+bool TranspositionTable::probe(uint64_t key, int& move, uint32_t& quality) const
+{
+	if (m_nBuckets == 0)
+		return false;
+
+	Bucket& bucket = bucketOf(key);
+	for (int e = 0; e < BUCKET_ENTRIES; e++)
+	{
+		const uint64_t data = bucket.entries[e].data.load(memory_order_relaxed);
+		const uint64_t check = bucket.entries[e].check.load(memory_order_relaxed);
+		if (holds(check, data, key))
+		{
+			move = static_cast<int>(data & 0xffffffff) - 1;
+			quality = static_cast<uint32_t>(data >> 32);
+			return true;
+		}
+	}
+
+	return false;
+}
+
+//A state already in the bucket is only overwritten by work at
+//least as good. Otherwise the new state takes the weakest of
+//the first three entries (an empty one if there is one) if it
+//is at least as good, or else the last entry.
+
+void TranspositionTable::store(uint64_t key, int move, uint32_t quality)
+{
+	if (m_nBuckets == 0)
+		return;
+
+	Bucket& bucket = bucketOf(key);
+	const uint64_t data = static_cast<uint64_t>(quality) << 32 |
+		static_cast<uint32_t>(move + 1);
+
+	int victim = -1;
+	long long weakest = 0;
+
+	for (int e = 0; e < BUCKET_ENTRIES; e++)
+	{
+		const uint64_t old = bucket.entries[e].data.load(memory_order_relaxed);
+		const uint64_t check = bucket.entries[e].check.load(memory_order_relaxed);
+		if (holds(check, old, key))
+		{
+			if ((old >> 32) > quality)
+				return;
+			victim = e;
+			weakest = -1;
+			break;
+		}
+
+		const long long strength = old == 0 ? -1 : static_cast<long long>(old >> 32);
+		if (e < BUCKET_ENTRIES - 1 && (victim < 0 || strength < weakest))
+		{
+			victim = e;
+			weakest = strength;
+		}
+	}
+
+	if (weakest > static_cast<long long>(quality))
+		victim = BUCKET_ENTRIES - 1;
+
+	bucket.entries[victim].data.store(data, memory_order_relaxed);
+	bucket.entries[victim].check.store(key ^ data, memory_order_relaxed);
+}
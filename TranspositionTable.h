@@ -0,0 +1,105 @@
+
+#ifndef TRANSPOSITIONTABLE_INCLUDED
+#define TRANSPOSITIONTABLE_INCLUDED
+
+#include "globals.h"
+#include <atomic>
+#include <cstdint>
+#include <cstddef>
+#include <memory>
+
+class Game;
+
+// A ShotKey is a Zobrist hash of what a player knows about the opponent's
+// board: its misses, its hits, and which ship each sinking shot sank.  Each
+// of those facts has a fixed random key, and the hash is the xor of the
+// keys of the facts so far, so two shot orders that reach the same state
+// get the same hash.  The hash starts from a key for the board size, the
+// fleet and a salt naming the strategy, so states of different games and
+// strategies do not collide.
+
+class ShotKey
+{
+public:
+    ShotKey(const Game& g, std::uint64_t salt);
+
+    void recordMiss(int cell)          { m_key ^= feature(MISS, cell); }
+    void recordHit(int cell)           { m_key ^= feature(HIT, cell); }
+      // The hit at cell sank the ship
+    void recordSink(int cell, int shipId)
+    {
+        m_key ^= feature(SINK, static_cast<std::uint64_t>(cell) << 24 | shipId);
+    }
+
+    std::uint64_t key() const { return m_key; }
+
+private:
+    enum { MISS, HIT, SINK, BOARD, SHIP, SALT };
+
+      // The key of one fact, made by scrambling its kind and value
+    static std::uint64_t feature(int kind, std::uint64_t value)
+    {
+        std::uint64_t x = static_cast<std::uint64_t>(kind) << 56 ^ value;
+        return Rng::splitMix(x);
+    }
+
+    std::uint64_t m_key;
+};
+
+// A TranspositionTable caches the move a strategy chose in a shot state,
+// together with a quality (such as the number of fleets sampled) that
+// says how much work went into it.  It has a fixed number of buckets of
+// four entries, each bucket one cache line, and any number of threads may
+// probe and store at once without locks: an entry keeps its key xored with
+// its data, so an entry torn by two stores at once just fails to match.
+//
+// Within a bucket the first three entries keep the highest-quality states
+// and the last one always takes the newest state that found no room, so a
+// few expensive states are not pushed out by many cheap ones.
+
+class TranspositionTable
+{
+public:
+      // A table of at most maxBytes; 0 makes a table that never hits
+    explicit TranspositionTable(std::size_t maxBytes);
+
+      // The table shared by every player in the process
+    static TranspositionTable& shared();
+
+      // Drop every entry and reallocate to at most maxBytes.  Not safe
+      // while other threads use the table.
+    void resize(std::size_t maxBytes);
+    void clear();
+    std::size_t bytes() const { return m_nBuckets * sizeof(Bucket); }
+
+      // If the state is in the table, set move and quality and return true
+    bool probe(std::uint64_t key, int& move, std::uint32_t& quality) const;
+    void store(std::uint64_t key, int move, std::uint32_t quality);
+
+    TranspositionTable(const TranspositionTable&) = delete;
+    TranspositionTable& operator=(const TranspositionTable&) = delete;
+
+private:
+    static const int BUCKET_ENTRIES = 4;
+
+    struct Entry
+    {
+        std::atomic<std::uint64_t> check;  // key ^ data
+        std::atomic<std::uint64_t> data;   // quality << 32 | move + 1
+    };
+    struct alignas(64) Bucket
+    {
+        Entry entries[BUCKET_ENTRIES];
+    };
+
+    Bucket& bucketOf(std::uint64_t key) const { return m_buckets[key & m_mask]; }
+
+    std::unique_ptr<Bucket[]> m_buckets;
+    std::size_t m_nBuckets;
+    std::uint64_t m_mask;
+};
+
+  // The default size of the shared table
+const std::size_t TRANSPOSITION_TABLE_BYTES = 16 << 20;
+
+#endif // TRANSPOSITIONTABLE_INCLUDED
@@ -0,0 +1,472 @@
+// Microbenchmarks for the board, player and game hot paths.
+//
+// Every benchmark uses a fixed seed, so two runs of the same build do the
+// same work, and the output of runs on different commits can be compared
+// line by line.  Build with every source file except main.cpp, e.g.
+//
+//     g++ -std=c++17 -O2 -pthread -I. bench/bench.cpp $(ls *.cpp | grep -v main.cpp)
+
+#include "Game.h"
+#include "Board.h"
+#include "Player.h"
+#include "Match.h"
+#include "BatchSim.h"
+#include "Heatmap.h"
+#include "PlacementTable.h"
+#include "TranspositionTable.h"
+#include "globals.h"
+#include <iostream>
+#include <iomanip>
+#include <string>
+#include <vector>
+#include <memory>
+#include <chrono>
+
+using namespace std;
+
+const uint64_t SEED = 20240601;
+
+//Results are folded into this so that the work being timed
+//cannot be optimized away
+
+static volatile long long sink;
+
+class Stopwatch
+{
+public:
+	Stopwatch() : m_start(chrono::steady_clock::now()) {}
+	double seconds() const
+	{
+		return chrono::duration<double>(chrono::steady_clock::now() - m_start).count();
+	}
+private:
+	chrono::steady_clock::time_point m_start;
+};
+
+static void report(const string& name, double seconds, long long ops)
+{
+	cout << left << setw(52) << name << right << fixed << setprecision(1)
+		<< setw(12) << seconds * 1e9 / ops << " ns/op"
+		<< setw(12) << ops << " ops" << endl;
+}
+
+static void reportRate(const string& name, double seconds, long long games)
+{
+	cout << left << setw(52) << name << right << fixed << setprecision(0)
+		<< setw(12) << games / seconds << " games/s"
+		<< setw(10) << games << " games" << endl;
+}
+
+//*********************************************************************
+//  Games and fleets
+//*********************************************************************
+
+bool addStandardShips(Game& g)
+{
+	return
+	g.addShip(5, 'A', "aircraft carrier")  &&
+	g.addShip(4, 'B', "battleship")  &&
+	g.addShip(3, 'D', "destroyer")  &&
+	g.addShip(3, 'S', "submarine")  &&
+	g.addShip(2, 'P', "patrol boat");
+}
+
+//A fleet of n ships of lengths 2 to 5, for the larger boards
+
+static void addShips(Game& g, int n)
+{
+	const string symbols = "ABCDEFGHIJKLMNPQRSTUVWYZ";
+	for (int k = 0; k < n; k++)
+		g.addShip(2 + k % 4, symbols[k % symbols.size()], "ship");
+}
+
+//Each board kind is a different board engine: the standard
+//game, a runtime-sized board that fits in a Bitboard, and a
+//large sparse board.
+
+struct BoardKind
+{
+	string name;
+	int rows;
+	int cols;
+	int nShips;   // 0 means the standard fleet
+};
+
+static const BoardKind BOARD_KINDS[] = {
+	{ "10x10 standard", 10, 10, 0 },
+	{ "14x14", 14, 14, 8 },
+	{ "300x300", 300, 300, 40 },
+};
+
+static void setUp(Game& g, const BoardKind& kind)
+{
+	g.reseed(SEED);
+	if (kind.nShips == 0)
+		addStandardShips(g);
+	else
+		addShips(g, kind.nShips);
+}
+
+//Ships in rows 0, 2, 4, ... at the left edge, so every board
+//kind gets the same layout
+
+static void placeFleet(const Game& g, Board& b)
+{
+	for (int s = 0; s < g.nShips(); s++)
+		b.placeShip(Point(2 * s % g.rows(), 2 * s / g.rows() * 6), s, HORIZONTAL);
+}
+
+//*********************************************************************
+//  Board benchmarks
+//*********************************************************************
+
+static void benchPlaceUnplace(const BoardKind& kind)
+{
+	Game g(kind.rows, kind.cols);
+	setUp(g, kind);
+	Board b(g);
+
+	const long long reps = 200000;
+	long long ok = 0;
+	Stopwatch t;
+	for (long long k = 0; k < reps; k++)
+	{
+		const int s = static_cast<int>(k % g.nShips());
+		const Point p(static_cast<int>(k % 3), static_cast<int>(k % 2));
+		ok += b.placeShip(p, s, HORIZONTAL);
+		ok += b.unplaceShip(p, s, HORIZONTAL);
+	}
+	report(kind.name + "  placeShip+unplaceShip", t.seconds(), reps);
+	sink = ok;
+}
+
+//Attacks are timed over many prepared boards, since each cell
+//can only be attacked once per board.
+
+static void benchAttack(const BoardKind& kind)
+{
+	Game g(kind.rows, kind.cols);
+	setUp(g, kind);
+
+	const int nBoards = kind.rows > 100 ? 20 : 2000;
+	vector< unique_ptr<Board> > boards;
+	for (int k = 0; k < nBoards; k++)
+	{
+		boards.push_back(unique_ptr<Board>(new Board(g)));
+		placeFleet(g, *boards.back());
+	}
+
+	//The first row that holds no ship supplies the misses
+
+	vector<Point> misses, hits, sinks;
+	for (int c = 0; c < g.cols(); c++)
+		misses.push_back(Point(1, c));
+	for (int s = 0; s < g.nShips() && 2 * s < g.rows(); s++)
+	{
+		for (int c = 0; c < g.shipLength(s) - 1; c++)
+			hits.push_back(Point(2 * s, c));
+		sinks.push_back(Point(2 * s, g.shipLength(s) - 1));
+	}
+
+	bool shotHit, destroyed;
+	int shipId;
+	long long n = 0;
+
+	const vector<Point>* lists[3] = { &misses, &hits, &sinks };
+	const char* names[3] = { "  attack (miss)", "  attack (hit)", "  attack (sink)" };
+
+	for (int k = 0; k < 3; k++)
+	{
+		Stopwatch t;
+		for (int bd = 0; bd < nBoards; bd++)
+			for (size_t j = 0; j < lists[k]->size(); j++)
+				n += boards[bd]->attack((*lists[k])[j], shotHit, destroyed, shipId) + destroyed;
+		report(kind.name + names[k], t.seconds(),
+			static_cast<long long>(nBoards) * lists[k]->size());
+	}
+
+	Board& last = *boards.back();
+	const long long reps = 1000000;
+	Stopwatch t;
+	for (long long k = 0; k < reps; k++)
+		n += last.allShipsDestroyed();
+	report(kind.name + "  allShipsDestroyed", t.seconds(), reps);
+
+	sink = n;
+}
+
+//*********************************************************************
+//  Player benchmarks
+//*********************************************************************
+
+static const char* AI_TYPES[] = { "awful", "mediocre", "good", "density", "montecarlo" };
+static const int N_AI_TYPES = sizeof(AI_TYPES) / sizeof(AI_TYPES[0]);
+
+//The Monte Carlo player samples for a fixed time before each
+//move, so it is timed over far fewer moves and games, and its
+//games/s mostly reflects that budget
+
+static bool isTimed(const string& type)
+{
+	return type == "montecarlo";
+}
+
+static void benchMediocrePlacement()
+{
+	Game g(10, 10);
+	addStandardShips(g);
+	g.reseed(SEED);
+	Board b(g);
+	Player* p = createPlayer("mediocre", "Mediocre", g);
+
+	const long long reps = 20000;
+	long long ok = 0;
+	Stopwatch t;
+	for (long long k = 0; k < reps; k++)
+	{
+		b.clear();
+		ok += p->placeShips(b);
+	}
+	report("10x10 standard  MediocrePlayer::placeShips", t.seconds(), reps);
+	sink = ok;
+	delete p;
+}
+
+//Play the player's own recommendations against a fixed fleet
+//until it has fired the given number of shots, then time how
+//long it takes to recommend the next one. A timed player would
+//find the same state in the shared transposition table on every
+//call after the first, so the table is turned off while it is
+//timed.
+
+static void benchRecommend(const string& type, int shotsFired, const string& stage)
+{
+	if (isTimed(type))
+		TranspositionTable::shared().resize(0);
+
+	Game g(10, 10);
+	addStandardShips(g);
+	g.reseed(SEED);
+	Board target(g);
+	Player* opponent = createPlayer("good", "Placer", g);
+	opponent->placeShips(target);
+
+	Player* p = createPlayer(type, type, g);
+	bool shotHit, destroyed;
+	int shipId;
+	for (int k = 0; k < shotsFired && !target.allShipsDestroyed(); k++)
+	{
+		Point q = p->recommendAttack();
+		bool valid = target.attack(q, shotHit, destroyed, shipId);
+		p->recordAttackResult(q, valid, shotHit, destroyed, shipId);
+	}
+
+	const long long reps = (isTimed(type) ? 200 : 100000);
+	long long n = 0;
+	Stopwatch t;
+	for (long long k = 0; k < reps; k++)
+	{
+		Point q = p->recommendAttack();
+		n += q.r + q.c;
+	}
+	report("10x10 standard  " + type + " recommendAttack (" + stage + ")",
+		t.seconds(), reps);
+	sink = n;
+	delete p;
+	delete opponent;
+
+	if (isTimed(type))
+		TranspositionTable::shared().resize(TRANSPOSITION_TABLE_BYTES);
+}
+
+//Build the heatmap of the standard fleet from scratch, with no
+//shots fired and with a scattering of misses and two hits
+
+static void benchHeatmap()
+{
+	Game g(10, 10);
+	addStandardShips(g);
+	g.reseed(SEED);
+	shared_ptr<const PlacementTable> table = PlacementTable::forGame(g);
+	vector<bool> afloat(g.nShips(), true);
+
+	Bitboard misses, hits;
+	const Bitboard none;
+	for (int k = 0; k < 25; k++)
+		misses.set(g.rng().randInt(100));
+	hits.set(44);
+	hits.set(45);
+	hits.andNot(misses);
+
+	int counts[100];
+	const long long reps = 20000;
+	long long n = 0;
+	const string kernel = heatmapKernel();
+
+	Stopwatch t;
+	for (long long k = 0; k < reps; k++)
+	{
+		shipHeatmap(*table, afloat, none, none, 1, counts);
+		n += counts[k % 100];
+	}
+	report("10x10 standard  shipHeatmap " + kernel + " (no shots)", t.seconds(), reps);
+
+	Stopwatch t2;
+	for (long long k = 0; k < reps; k++)
+	{
+		shipHeatmap(*table, afloat, misses, hits, 16, counts);
+		n += counts[k % 100];
+	}
+	report("10x10 standard  shipHeatmap " + kernel + " (misses, hits)", t2.seconds(), reps);
+
+	sink = n;
+}
+
+//*********************************************************************
+//  Checks
+//*********************************************************************
+
+//The two heatmap kernels must agree cell for cell and on the
+//number of legal masks, or a strategy would play differently
+//on a processor without AVX2. Random masks and shots are tried
+//on a few board sizes, along with whole fleets, whose runs of
+//masks may be counted more than once. Where AVX2 is missing
+//both sides are the scalar loop and the check is trivial.
+
+const int HEATMAP_CHECKS = 2000;
+const int HEATMAP_CHECK_SIZES[][2] = { { 10, 10 }, { 7, 9 }, { 16, 16 } };
+
+  // Each of the first nCells cells with probability 1/8
+static Bitboard sparse(int nCells, Rng& rng)
+{
+	Bitboard b = Bitboard::random(nCells, rng);
+	b &= Bitboard::random(nCells, rng);
+	b &= Bitboard::random(nCells, rng);
+	return b;
+}
+
+static bool checkHeatmap()
+{
+	Rng rng(SEED);
+	int failures = 0;
+
+	for (int k = 0; k < HEATMAP_CHECKS; k++)
+	{
+		const int rows = HEATMAP_CHECK_SIZES[k % 3][0];
+		const int cols = HEATMAP_CHECK_SIZES[k % 3][1];
+		const int nCells = rows * cols;
+
+		const Bitboard misses = sparse(nCells, rng);
+		Bitboard hits = sparse(nCells, rng);
+		hits.andNot(misses);
+		const int hitWeight = 1 + rng.randInt(20);
+
+		//Enough masks in the first case to need more than
+		//one flush of the AVX2 counters
+
+		const int nMasks = (k == 0 ? 70000 : 1 + rng.randInt(300));
+		vector<Bitboard> masks(nMasks);
+		for (int m = 0; m < nMasks; m++)
+		{
+			masks[m] = Bitboard::random(nCells, rng);
+			masks[m] &= Bitboard::random(nCells, rng);
+		}
+
+		vector<int> counts(nCells, 0), expected(nCells, 0);
+		const int legal = addHeatmap(masks.data(), nMasks, misses, hits,
+			hitWeight, counts.data(), nCells);
+		const int expectedLegal = addHeatmapScalar(masks.data(), nMasks, misses,
+			hits, hitWeight, expected.data(), nCells);
+		bool same = (legal == expectedLegal && counts == expected);
+
+		Game g(rows, cols);
+		if (k % 2 == 0)
+			addStandardShips(g);
+		else
+			addShips(g, 2 + rng.randInt(8));
+		vector<bool> afloat(g.nShips());
+		for (int s = 0; s < g.nShips(); s++)
+			afloat[s] = rng.randInt(4) != 0;
+
+		shared_ptr<const PlacementTable> table = PlacementTable::forGame(g);
+		shipHeatmap(*table, afloat, misses, hits, hitWeight, counts.data());
+		shipHeatmapScalar(*table, afloat, misses, hits, hitWeight, expected.data());
+		if (counts != expected)
+			same = false;
+
+		if (!same)
+			failures++;
+	}
+
+	cout << "check  heatmap " << heatmapKernel() << " vs scalar: ";
+	if (failures == 0)
+		cout << HEATMAP_CHECKS << " cases agree" << endl;
+	else
+		cout << failures << " of " << HEATMAP_CHECKS << " cases DIFFER" << endl;
+	return failures == 0;
+}
+
+//*********************************************************************
+//  Whole games
+//*********************************************************************
+
+static void benchGames(const string& type0, const string& type1)
+{
+	MatchConfig config;
+	config.addShips = addStandardShips;
+	config.type[0] = type0;
+	config.name[0] = type0;
+	config.type[1] = type1;
+	config.name[1] = type1;
+	config.seed = SEED;
+
+	//Moves the shared transposition table kept from earlier
+	//benchmarks would make a timed player look faster
+
+	const bool timed = isTimed(type0) || isTimed(type1);
+	if (timed)
+		TranspositionTable::shared().clear();
+
+	const long long games = (timed ? 20 : 5000);
+	Stopwatch t;
+	MatchResult r = runMatch(config, games, 1);
+	reportRate("games  " + type0 + " vs " + type1, t.seconds(), r.stats.games);
+}
+
+static void benchBatch(BatchStrategy s0, BatchStrategy s1, const string& name)
+{
+	const long long games = 100000;
+	Stopwatch t;
+	MatchResult r = runBatchMatch(s0, s1, games, SEED);
+	reportRate("batch  " + name, t.seconds(), r.stats.games);
+}
+
+int main()
+{
+	for (size_t k = 0; k < sizeof(BOARD_KINDS) / sizeof(BOARD_KINDS[0]); k++)
+	{
+		benchPlaceUnplace(BOARD_KINDS[k]);
+		benchAttack(BOARD_KINDS[k]);
+	}
+
+	const bool heatmapAgrees = checkHeatmap();
+
+	benchMediocrePlacement();
+	benchHeatmap();
+
+	for (int k = 0; k < N_AI_TYPES; k++)
+	{
+		benchRecommend(AI_TYPES[k], 0, "early");
+		benchRecommend(AI_TYPES[k], 30, "mid");
+		benchRecommend(AI_TYPES[k], 60, "late");
+	}
+
+	for (int j = 0; j < N_AI_TYPES; j++)
+		for (int k = 0; k < N_AI_TYPES; k++)
+			benchGames(AI_TYPES[j], AI_TYPES[k]);
+
+	benchBatch(BATCH_AWFUL, BATCH_HUNT_TARGET, "awful vs hunt/target");
+	benchBatch(BATCH_HUNT_TARGET, BATCH_HUNT_TARGET, "hunt/target vs hunt/target");
+
+	return heatmapAgrees ? 0 : 1;
+}
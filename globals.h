@@ -2,9 +2,10 @@
 #define GLOBALS_INCLUDED
 
 #include <random>
+#include <cstdint>
 
-const int MAXROWS = 10;
-const int MAXCOLS = 10;
+const int MAXROWS = 1000;
+const int MAXCOLS = 1000;
 
 enum Direction {
     HORIZONTAL, VERTICAL
@@ -19,13 +20,68 @@ public:
     int c;
 };
 
-// Return a uniformly distributed random int from 0 to limit-1
-inline int randInt(int limit)
+// An Rng is a small, fast pseudo-random generator (xoshiro256**).  Each
+// Game owns one, so games on different threads never share state, and a
+// game seeded with the same value plays out the same way every time.
+
+class Rng
 {
-    static std::random_device rd;
-    static std::mt19937 generator(rd());
-    std::uniform_int_distribution<> distro(0, limit-1);
-    return distro(generator);
-}
+public:
+    explicit Rng(std::uint64_t s = 0) { seed(s); }
+
+      // Restart the sequence; the 256-bit state is expanded from s with
+      // splitmix64 so that nearby seeds give unrelated sequences
+    void seed(std::uint64_t s)
+    {
+        for (int k = 0; k < 4; k++)
+            m_state[k] = splitMix(s);
+    }
+
+    std::uint64_t next()
+    {
+        const std::uint64_t result = rotl(m_state[1] * 5, 7) * 9;
+        const std::uint64_t t = m_state[1] << 17;
+        m_state[2] ^= m_state[0];
+        m_state[3] ^= m_state[1];
+        m_state[1] ^= m_state[2];
+        m_state[0] ^= m_state[3];
+        m_state[2] ^= t;
+        m_state[3] = rotl(m_state[3], 45);
+        return result;
+    }
+
+      // Return a uniformly distributed random int from 0 to limit-1.  The
+      // top 32 bits of a draw are scaled by limit with a multiply and a
+      // shift instead of a division.
+    int randInt(int limit)
+    {
+        return static_cast<int>(((next() >> 32) *
+                                 static_cast<std::uint64_t>(limit)) >> 32);
+    }
+
+      // A seed taken from the system's entropy source
+    static std::uint64_t randomSeed()
+    {
+        std::random_device rd;
+        return (static_cast<std::uint64_t>(rd()) << 32) ^ rd();
+    }
+
+      // One step of splitmix64, also handy for deriving per-game seeds
+    static std::uint64_t splitMix(std::uint64_t& x)
+    {
+        std::uint64_t z = (x += 0x9e3779b97f4a7c15ULL);
+        z = (z ^ (z >> 30)) * 0xbf58476d1ce4e5b9ULL;
+        z = (z ^ (z >> 27)) * 0x94d049bb133111ebULL;
+        return z ^ (z >> 31);
+    }
+
+private:
+    static std::uint64_t rotl(std::uint64_t x, int k)
+    {
+        return (x << k) | (x >> (64 - k));
+    }
+
+    std::uint64_t m_state[4];
+};
 
 #endif // GLOBALS_INCLUDED
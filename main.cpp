@@ -1,6 +1,9 @@
 #include "Game.h"
 #include "Player.h"
+#include "Match.h"
 #include <iostream>
+#include <iomanip>
+#include <algorithm>
 #include <string>
 
 using namespace std;
@@ -18,6 +21,34 @@ bool addStandardShips(Game& g)
     g.addShip(2, 'P', "patrol boat");
 }
 
+void reportMatch(const MatchConfig& config, const MatchResult& result, int player)
+{
+    const MatchStats& stats = result.stats;
+    const Interval win = stats.winRate(player);
+    const Interval first = stats.firstMoverRate();
+    cout << fixed << setprecision(1);
+    cout << "  " << config.name[player] << " won " << 100.0 * stats.wins[player] /
+         max(stats.decided(), 1LL) << "% (95% CI " << 100 * win.low << "% to "
+         << 100 * win.high << "%)" << endl;
+    cout << "  Whoever moved first won " << 100.0 * stats.firstMoverWins /
+         max(stats.decided(), 1LL) << "% (95% CI " << 100 * first.low << "% to "
+         << 100 * first.high << "%)" << endl;
+
+    const RunningStat& shots = stats.shotsToWin[player];
+    const Histogram& counts = stats.shotsToWinCounts[player];
+    cout << "  Shots to win: mean " << shots.mean << ", sd " << shots.stddev()
+         << ", median " << counts.quantile(0.5) << ", 90% within "
+         << counts.quantile(0.9) << endl;
+
+    Game g(config.rows, config.cols);
+    config.addShips(g);
+    cout << "  Shot that sank each ship:";
+    for (size_t s = 0; s < stats.timeToSink[player].size(); s++)
+        cout << (s == 0 ? " " : ", ") << g.shipName(static_cast<int>(s)) << " "
+             << stats.timeToSink[player][s].mean;
+    cout << endl;
+}
+
 int main()
 {
     const int NTRIALS = 100;
@@ -31,6 +62,8 @@ int main()
     cout << "  4.  A " << NTRIALS
     << "-game match between a mediocre and an good player, with no pauses"
     << endl;
+    cout << "  5.  A match between a mediocre and a good player that stops once"
+    << " one is clearly better" << endl;
     cout << "Enter your choice: ";
     string line;
     getline(cin,line);
@@ -61,54 +94,74 @@ int main()
     }
     else if (line[0] == '3')
     {
-        int nMediocreWins = 0;
-        
-        for (int k = 1; k <= NTRIALS; k++)
+        MatchConfig config;
+        config.addShips = addStandardShips;
+        config.type[0] = "awful";
+        config.name[0] = "Awful Audrey";
+        config.type[1] = "mediocre";
+        config.name[1] = "Mediocre Mimi";
+        MatchResult result = runMatch(config, NTRIALS);
+        if (!result.ok)
+            cout << "The fleet could not be set up, so no games were played."
+            << endl;
+        else
         {
-            cout << "============================= Game " << k
-            << " =============================" << endl;
-            Game g(10, 10);
-            addStandardShips(g);
-            Player* p1 = createPlayer("awful", "Awful Audrey", g);
-            Player* p2 = createPlayer("mediocre", "Mediocre Mimi", g);
-            Player* winner = (k % 2 == 1 ?
-                              g.play(p1, p2, false) : g.play(p2, p1, false));
-            if (winner == p2)
-                nMediocreWins++;
-            delete p1;
-            delete p2;
+            cout << "The mediocre player won " << result.stats.wins[1] << " out of "
+            << NTRIALS << " games." << endl;
+            reportMatch(config, result, 1);
         }
-        cout << "The mediocre player won " << nMediocreWins << " out of "
-        << NTRIALS << " games." << endl;
         // We'd expect a mediocre player to win most of the games against
         // an awful player.  Similarly, a good player should outperform
         // a mediocre player.
     }
     else if (line[0] == '4')
     {
-        int nGoodWins = 0;
-        
-        for (int k = 1; k <= NTRIALS; k++)
+        MatchConfig config;
+        config.addShips = addStandardShips;
+        config.type[0] = "mediocre";
+        config.name[0] = "Mediocre Mimi";
+        config.type[1] = "good";
+        config.name[1] = "Good Stephen";
+        MatchResult result = runMatch(config, NTRIALS);
+        if (!result.ok)
+            cout << "The fleet could not be set up, so no games were played."
+            << endl;
+        else
         {
-            cout << "============================= Game " << k
-            << " =============================" << endl;
-            Game g(10, 10);
-            addStandardShips(g);
-            Player* p1 = createPlayer("mediocre", "Mediocre Mimi", g);
-            Player* p2 = createPlayer("good", "Good Stephen", g);
-            Player* winner = (k % 2 == 1 ?
-                              g.play(p1, p2, false) : g.play(p2, p1, false));
-            if (winner == p2)
-                nGoodWins++;
-            delete p1;
-            delete p2;
+            cout << "The Good player won " << result.stats.wins[1] << " out of "
+            << NTRIALS << " games." << endl;
+            reportMatch(config, result, 1);
         }
-        cout << "The Good player won " << nGoodWins << " out of "
-        << NTRIALS << " games." << endl;
         // We'd expect a mediocre player to win most of the games against
         // an awful player.  Similarly, a good player should outperform
         // a mediocre player.
     }
+    else if (line[0] == '5')
+    {
+        MatchConfig config;
+        config.addShips = addStandardShips;
+        config.type[0] = "mediocre";
+        config.name[0] = "Mediocre Mimi";
+        config.type[1] = "good";
+        config.name[1] = "Good Stephen";
+        SequentialTest test;
+        test.batch = 20;
+        SequentialResult result = runSequentialMatch(config, test);
+        if (!result.match.ok)
+            cout << "The fleet could not be set up, so no games were played."
+            << endl;
+        else
+        {
+            if (result.even)
+                cout << "Neither player was found better";
+            else if (result.better < 0)
+                cout << "The match was not settled";
+            else
+                cout << config.name[result.better] << " was found better";
+            cout << " after " << result.match.stats.games << " games." << endl;
+            reportMatch(config, result.match, 1);
+        }
+    }
     else
     {
         cout << "That's not one of the choices." << endl;
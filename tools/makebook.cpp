@@ -0,0 +1,269 @@
+// Builds an opening book for one board size and fleet.
+//
+// Starting from the empty board, the tool draws a fixed number of fleets
+// uniformly at random, keeps those that agree with the shots, and picks
+// the unfired cell the most of them cover.  It then follows each outcome
+// of that shot (a miss, a hit, or a hit that sinks some ship) to the next
+// state, down to the requested depth, dropping states so unlikely that
+// fewer than MIN_FLEETS of the fleets drawn agree with them.  States
+// reached by more than one order of shots are worked out once.  The fleets
+// drawn for a state depend only on the state, so the same arguments always
+// give the same book, however many threads draw them.
+//
+//     g++ -std=c++17 -O2 -pthread -I. tools/makebook.cpp $(ls *.cpp | grep -v main.cpp) -o makebook
+//     ./makebook standard.book 10 200000 10 10 5 4 3 3 2
+//     BATTLESHIP_BOOK=standard.book ./battleship
+
+#include "Game.h"
+#include "OpeningBook.h"
+#include "TranspositionTable.h"
+#include "PlacementTable.h"
+#include "Bitboard.h"
+#include "globals.h"
+#include <iostream>
+#include <string>
+#include <vector>
+#include <memory>
+#include <thread>
+#include <unordered_set>
+#include <cstdlib>
+
+using namespace std;
+
+const int CHUNK = 4096;        // fleets drawn from one seed
+const long long MIN_FLEETS = 1000;
+
+//The placements a ship may be on: for a ship afloat, those that
+//miss every miss and are not wholly hit; for a sunk ship, those
+//it could have had when it sank
+
+struct State
+{
+	State(const Game& g, const PlacementTable& table);
+	void record(const PlacementTable& table, int cell, bool shotHit, int sunkShip);
+
+	vector< vector<int> > candidates;
+	vector<bool> afloat;
+	Bitboard fired;
+	Bitboard hits;
+	ShotKey key;
+};
+
+State::State(const Game& g, const PlacementTable& table)
+ : candidates(g.nShips()), afloat(g.nShips(), true), key(g, BOOK_SALT)
+{
+	for (int ship = 0; ship < g.nShips(); ship++)
+		for (int k = 0; k < table.count(ship); k++)
+			candidates[ship].push_back(k);
+}
+
+void State::record(const PlacementTable& table, int cell, bool shotHit, int sunkShip)
+{
+	fired.set(cell);
+	if (shotHit)
+	{
+		hits.set(cell);
+		key.recordHit(cell);
+	}
+	else
+		key.recordMiss(cell);
+	if (sunkShip >= 0)
+	{
+		key.recordSink(cell, sunkShip);
+		afloat[sunkShip] = false;
+	}
+
+	for (size_t ship = 0; ship < candidates.size(); ship++)
+	{
+		vector<int>& live = candidates[ship];
+		size_t kept = 0;
+		for (size_t j = 0; j < live.size(); j++)
+		{
+			const Bitboard& mask = table.mask(static_cast<int>(ship), live[j]);
+			bool keep;
+			if (static_cast<int>(ship) == sunkShip)
+				keep = mask.test(cell) && mask.isSubsetOf(hits);
+			else if (!afloat[ship])
+				keep = true;
+			else if (!shotHit)
+				keep = !mask.test(cell);
+			else
+				keep = !mask.isSubsetOf(hits);
+			if (keep)
+				live[kept++] = live[j];
+		}
+		live.resize(kept);
+	}
+}
+
+class BookMaker
+{
+public:
+	BookMaker(const Game& g, int depth, long long samples, int nThreads)
+	 : m_game(g), m_table(PlacementTable::forGame(g)), m_depth(depth),
+		m_nChunks((samples + CHUNK - 1) / CHUNK), m_nThreads(nThreads)
+	{}
+
+	void expand(const State& s, int depth);
+	const vector<BookEntry>& entries() const { return m_entries; }
+
+private:
+	void draw(const State& s, int thread, vector<long long>& counts,
+		long long& kept) const;
+
+	const Game& m_game;
+	shared_ptr<const PlacementTable> m_table;
+	int m_depth;
+	long long m_nChunks;
+	int m_nThreads;
+	unordered_set<uint64_t> m_seen;
+	vector<BookEntry> m_entries;
+};
+
+//Chunk k of a state is always drawn from the same seed, whichever
+//thread draws it. A fleet is kept if no two ships overlap and
+//every hit is covered.
+
+void BookMaker::draw(const State& s, int thread, vector<long long>& counts,
+	long long& kept) const
+{
+	counts.assign(m_game.rows() * m_game.cols(), 0);
+	kept = 0;
+
+	Rng rng;
+	for (long long k = thread; k < m_nChunks; k += m_nThreads)
+	{
+		uint64_t seed = s.key.key() ^ static_cast<uint64_t>(k);
+		rng.seed(Rng::splitMix(seed));
+		for (int j = 0; j < CHUNK; j++)
+		{
+			Bitboard ships;
+			bool overlap = false;
+			for (size_t ship = 0; ship < s.candidates.size() && !overlap; ship++)
+			{
+				const vector<int>& live = s.candidates[ship];
+				const Bitboard& mask = m_table->mask(static_cast<int>(ship),
+					live[rng.randInt(static_cast<int>(live.size()))]);
+				overlap = mask.intersects(ships);
+				ships |= mask;
+			}
+			if (overlap || !s.hits.isSubsetOf(ships))
+				continue;
+			kept++;
+			ships.andNot(s.fired);
+			forEachCell(ships, [&](int cell) { counts[cell]++; });
+		}
+	}
+}
+
+void BookMaker::expand(const State& s, int depth)
+{
+	if (depth == m_depth || !m_seen.insert(s.key.key()).second)
+		return;
+	for (size_t ship = 0; ship < s.candidates.size(); ship++)
+		if (s.candidates[ship].empty())
+			return;
+
+	vector< vector<long long> > counts(m_nThreads);
+	vector<long long> kept(m_nThreads);
+	vector<thread> helpers;
+	for (int t = 1; t < m_nThreads; t++)
+		helpers.push_back(thread(&BookMaker::draw, this, cref(s), t,
+			ref(counts[t]), ref(kept[t])));
+	draw(s, 0, counts[0], kept[0]);
+	for (size_t t = 0; t < helpers.size(); t++)
+		helpers[t].join();
+
+	const int nCells = m_game.rows() * m_game.cols();
+	for (int t = 1; t < m_nThreads; t++)
+	{
+		for (int cell = 0; cell < nCells; cell++)
+			counts[0][cell] += counts[t][cell];
+		kept[0] += kept[t];
+	}
+	if (kept[0] < MIN_FLEETS)
+		return;
+
+	//Ties go to the lowest cell, so the book does not depend on
+	//any Rng
+
+	int best = -1;
+	for (int cell = 0; cell < nCells; cell++)
+		if (!s.fired.test(cell) && (best < 0 || counts[0][cell] > counts[0][best]))
+			best = cell;
+	if (best < 0)
+		return;
+
+	BookEntry entry;
+	entry.key = s.key.key();
+	entry.move = best;
+	entry.quality = static_cast<uint32_t>(min(kept[0], 0xffffffffLL));
+	m_entries.push_back(entry);
+	if (m_entries.size() % 256 == 0)
+		cerr << m_entries.size() << " states" << endl;
+
+	State miss(s);
+	miss.record(*m_table, best, false, -1);
+	expand(miss, depth + 1);
+
+	State hit(s);
+	hit.record(*m_table, best, true, -1);
+	expand(hit, depth + 1);
+
+	for (int ship = 0; ship < m_game.nShips(); ship++)
+	{
+		if (!s.afloat[ship])
+			continue;
+		State sink(s);
+		sink.record(*m_table, best, true, ship);
+		expand(sink, depth + 1);
+	}
+}
+
+int main(int argc, char* argv[])
+{
+	if (argc < 7)
+	{
+		cerr << "usage: " << argv[0]
+			<< " book depth samples rows cols length..." << endl;
+		return 1;
+	}
+
+	const string path = argv[1];
+	const int depth = atoi(argv[2]);
+	const long long samples = atoll(argv[3]);
+	const int rows = atoi(argv[4]);
+	const int cols = atoi(argv[5]);
+
+	Game g(rows, cols);
+	for (int k = 6; k < argc; k++)
+	{
+		const int s = k - 6;
+		if (!g.addShip(atoi(argv[k]), static_cast<char>('A' + s % 26),
+				"ship " + to_string(s)))
+		{
+			cerr << "cannot add a ship of length " << argv[k] << endl;
+			return 1;
+		}
+	}
+	if (!PlacementTable::fits(rows, cols))
+	{
+		cerr << "the board is too large for an opening book" << endl;
+		return 1;
+	}
+
+	int nThreads = static_cast<int>(thread::hardware_concurrency());
+	if (nThreads <= 0)
+		nThreads = 1;
+
+	BookMaker maker(g, depth, samples, nThreads);
+	maker.expand(State(g, *PlacementTable::forGame(g)), 0);
+
+	if (!OpeningBook::write(path, g, maker.entries()))
+	{
+		cerr << "cannot write " << path << endl;
+		return 1;
+	}
+	cout << maker.entries().size() << " states written to " << path << endl;
+	return 0;
+}
@@ -0,0 +1,124 @@
+// Replays the games of a binary game log (see GameLog.h), showing each shot
+// and the board it was fired at the way the console display does.
+//
+//     g++ -std=c++17 -O2 -pthread -I. tools/replay.cpp $(ls *.cpp | grep -v main.cpp) -o replay
+//     ./replay games.log          every game in the log
+//     ./replay games.log 42       only game number 42
+//     ./replay games.log -s       one summary line per game
+
+#include "GameLog.h"
+#include "Game.h"
+#include "Board.h"
+#include "globals.h"
+#include <iostream>
+#include <fstream>
+#include <string>
+#include <cstdlib>
+#include <cstring>
+
+using namespace std;
+
+static void summarize(const LoggedGame& lg)
+{
+	int shots[2] = { 0, 0 };
+	for (size_t k = 0; k < lg.shots.size(); k++)
+		shots[k % 2]++;
+	cout << "game " << lg.gameNumber << "  seed " << lg.seed << "  "
+		<< lg.rows << "x" << lg.cols << "  " << lg.ships.size() << " ships  shots "
+		<< shots[0] << "/" << shots[1] << "  winner "
+		<< (lg.winnerIndex < 0 ? string("none") : to_string(lg.winnerIndex + 1)) << endl;
+}
+
+//The boards are rebuilt from the placements and the shots are
+//fired at them again, so the display is exactly the game's
+
+static bool replay(const LoggedGame& lg)
+{
+	Game g(lg.rows, lg.cols);
+	for (size_t s = 0; s < lg.ships.size(); s++)
+		if (!g.addShip(lg.ships[s].length, lg.ships[s].symbol, lg.ships[s].name))
+			return false;
+
+	Board b1(g);
+	Board b2(g);
+	Board* boards[2] = { &b1, &b2 };
+	for (int b = 0; b < 2; b++)
+		for (size_t s = 0; s < lg.ships.size(); s++)
+			if (!boards[b]->placeShip(lg.placements[b][s].topOrLeft, static_cast<int>(s),
+					lg.placements[b][s].dir))
+				return false;
+
+	summarize(lg);
+
+	for (size_t k = 0; k < lg.shots.size(); k++)
+	{
+		const int turn = static_cast<int>(k % 2);
+		const LoggedShot& shot = lg.shots[k];
+		Board& target = *boards[1 - turn];
+		const string name = "Player " + to_string(turn + 1);
+
+		bool shotHit = false;
+		bool destroyed = false;
+		int shipId = -1;
+		const bool valid = target.attack(shot.p, shotHit, destroyed, shipId);
+		if (valid != shot.valid || shotHit != shot.hit || destroyed != shot.sank)
+			cout << "(the log disagrees with the boards here)" << endl;
+
+		if (!valid)
+		{
+			cout << name << " wasted a shot at (" << shot.p.r << "," << shot.p.c << ")" << endl;
+			continue;
+		}
+
+		cout << name << " attacked (" << shot.p.r << "," << shot.p.c << ") and ";
+		if (!shotHit)
+			cout << "missed, resulting in:" << endl;
+		else if (!destroyed)
+			cout << "hit something, resulting in:" << endl;
+		else
+			cout << "destroyed the " << g.shipName(shipId) << ", resulting in:" << endl;
+		target.display(false);
+	}
+
+	if (lg.winnerIndex >= 0)
+		cout << "Player " << lg.winnerIndex + 1 << " wins" << endl;
+	cout << endl;
+	return true;
+}
+
+int main(int argc, char* argv[])
+{
+	if (argc < 2 || argc > 3)
+	{
+		cerr << "usage: " << argv[0] << " log [game-number | -s]" << endl;
+		return 1;
+	}
+
+	ifstream in(argv[1], ios::binary);
+	GameLogReader reader(in);
+	if (!reader.ok())
+	{
+		cerr << argv[1] << " is not a game log" << endl;
+		return 1;
+	}
+
+	const bool summaryOnly = argc == 3 && strcmp(argv[2], "-s") == 0;
+	const long long only = argc == 3 && !summaryOnly ? atoll(argv[2]) : -1;
+
+	LoggedGame lg;
+	long long nGames = 0;
+	while (reader.next(lg))
+	{
+		nGames++;
+		if (only >= 0 && lg.gameNumber != only)
+			continue;
+		if (summaryOnly)
+			summarize(lg);
+		else if (!replay(lg))
+			cout << "game " << lg.gameNumber << " cannot be set up again" << endl;
+	}
+
+	if (!reader.atEnd())
+		cerr << "stopped at a damaged record after " << nGames << " games" << endl;
+	return 0;
+}